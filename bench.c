@@ -0,0 +1,399 @@
+/*
+*****************************************************************************
+Times the clinic core on a pair of data files (see gendata.c to make them)
+  and prints the results as JSON: the imports, sorting the appointments,
+    the patient number and phone lookups, the timeslot conflict checks
+           and the schedule views. Lookups use random keys.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "clinic.h"
+#include "fileio.h"
+#include "index.h"
+#include "report.h"
+
+// Lookups timed by each lookup benchmark unless --operations is given
+#define BENCH_DEFAULT_OPERATIONS 1000000
+
+// Most days rendered by the schedule_day benchmark
+#define BENCH_MAX_DAYS 10000
+
+// Initial table sizes (as main.c uses), both tables grow while importing
+#define BENCH_INITIAL_PATIENTS 64
+#define BENCH_INITIAL_APPOINTMENTS 256
+
+// Timing of one benchmark
+struct BenchResult
+{
+    const char* name;
+    long operations;
+    long long nanoseconds;
+    long long checksum;             // sum of what was found, so the work can't be skipped
+};
+
+
+// Gets the monotonic clock in nanoseconds
+static long long nowNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Gets the next pseudo-random number (xorshift64*, the same seed always gives the same keys)
+static unsigned long long nextRandom(unsigned long long* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+// Gets a pseudo-random number from 0 up to (not including) limit
+static int randomBelow(unsigned long long* state, int limit)
+{
+    return (int)((nextRandom(state) >> 11) % (unsigned long long)limit);
+}
+
+// Gets the slot of a random patient (the table must have one)
+static int randomPatient(const struct ClinicData* data, unsigned long long* random)
+{
+    return (int)randomBelow(random, data->maxPatient);
+}
+
+// Prints text as a JSON string
+static void printJsonString(const char* text)
+{
+    putchar('"');
+
+    for (; *text != '\0'; text++)
+    {
+        if (*text == '"' || *text == '\\')
+        {
+            putchar('\\');
+        }
+
+        putchar(*text);
+    }
+
+    putchar('"');
+}
+
+// Prints a result as a JSON object (followed by a comma unless it is the last one)
+static void printResult(const struct BenchResult* result, int last)
+{
+    printf("    { \"name\": \"%s\", \"operations\": %ld, \"total_ns\": %lld, \"ns_per_op\": %.1f, \"checksum\": %lld }%s\n",
+           result->name, result->operations, result->nanoseconds,
+           result->operations > 0 ? (double)result->nanoseconds / result->operations : 0.0,
+           result->checksum, last ? "" : ",");
+}
+
+// Sorts a copy of the appointment columns, shuffled first unless presorted is set
+static void benchSort(struct BenchResult* result, const struct ClinicData* data, int presorted,
+                      unsigned long long* random)
+{
+    int* patients = malloc(sizeof(*patients) * (data->maxAppointments + 1));
+    unsigned int* times = malloc(sizeof(*times) * (data->maxAppointments + 1));
+    unsigned int time;
+    long long start;
+    int patient;
+    int other;
+    int i;
+
+    if (patients != NULL && times != NULL)
+    {
+        memcpy(patients, data->appointmentPatients, sizeof(*patients) * data->maxAppointments);
+        memcpy(times, data->appointmentTimes, sizeof(*times) * data->maxAppointments);
+
+        for (i = data->maxAppointments - 1; !presorted && i > 0; i--)
+        {
+            other = randomBelow(random, i + 1);
+            patient = patients[i];
+            time = times[i];
+            patients[i] = patients[other];
+            times[i] = times[other];
+            patients[other] = patient;
+            times[other] = time;
+        }
+
+        start = nowNanoseconds();
+        sortAppointments(patients, times, data->maxAppointments);
+        result->nanoseconds = nowNanoseconds() - start;
+        result->operations = data->maxAppointments;
+        result->checksum = data->maxAppointments > 0 ? times[0] + (long long)times[data->maxAppointments - 1] : 0;
+    }
+
+    free(patients);
+    free(times);
+}
+
+// Looks up random patients by number
+static void benchPatientNumbers(struct BenchResult* result, const struct ClinicData* data, long operations,
+                                unsigned long long* random)
+{
+    int* numbers = malloc(sizeof(*numbers) * operations);
+    long long start;
+    long i;
+
+    if (numbers != NULL && data->maxPatient > 0)
+    {
+        for (i = 0; i < operations; i++)
+        {
+            numbers[i] = data->patientNumbers[randomPatient(data, random)];
+        }
+
+        start = nowNanoseconds();
+
+        for (i = 0; i < operations; i++)
+        {
+            result->checksum += findPatientIndexByPatientNum(numbers[i], data);
+        }
+
+        result->nanoseconds = nowNanoseconds() - start;
+        result->operations = operations;
+    }
+
+    free(numbers);
+}
+
+// Finds every patient sharing the phone of random patients
+static void benchPhones(struct BenchResult* result, const struct ClinicData* data, long operations,
+                        unsigned long long* random)
+{
+    long long* phones = malloc(sizeof(*phones) * operations);
+    long long start;
+    long i;
+    int index;
+
+    if (phones != NULL && data->maxPatient > 0)
+    {
+        for (i = 0; i < operations; i++)
+        {
+            phones[i] = data->patientPhones[randomPatient(data, random)];
+        }
+
+        start = nowNanoseconds();
+
+        for (i = 0; i < operations; i++)
+        {
+            if (data->phoneTable != NULL)
+            {
+                for (index = lookupPhone(data, phones[i]); index != -1; index = nextPhonePatient(data, index))
+                {
+                    result->checksum++;
+                }
+            }
+            else
+            {
+                for (index = 0; index < data->maxPatient; index++)
+                {
+                    result->checksum += data->patientPhones[index] == phones[i];
+                }
+            }
+        }
+
+        result->nanoseconds = nowNanoseconds() - start;
+        result->operations = operations;
+    }
+
+    free(phones);
+}
+
+// Checks random timeslots on the booked days for conflicts (booked is set: looks up booked appointments instead)
+static void benchConflicts(struct BenchResult* result, const struct ClinicData* data, long operations, int booked,
+                           unsigned long long* random)
+{
+    struct Appointment* appointments = malloc(sizeof(*appointments) * operations);
+    long long start;
+    long i;
+    int slot;
+
+    if (appointments != NULL && data->maxAppointments > 0)
+    {
+        for (i = 0; i < operations; i++)
+        {
+            appointmentAt(data, randomBelow(random, data->maxAppointments), &appointments[i]);
+
+            if (!booked)
+            {
+                slot = randomBelow(random, SLOTS_PER_DAY);
+                appointments[i].time.hour = START_HOUR + slot * MINUTE_INTERVAL / 60;
+                appointments[i].time.min = slot * MINUTE_INTERVAL % 60;
+            }
+        }
+
+        start = nowNanoseconds();
+
+        for (i = 0; i < operations; i++)
+        {
+            result->checksum += booked ? findBookedAppointment(data, &appointments[i])
+                                       : isSlotTaken(data, &appointments[i]);
+        }
+
+        result->nanoseconds = nowNanoseconds() - start;
+        result->operations = operations;
+    }
+
+    free(appointments);
+}
+
+// Renders the schedule of random booked days, as the menu shows one day
+static void benchScheduleDays(struct BenchResult* result, const struct ClinicData* data, long operations,
+                              unsigned long long* random)
+{
+    struct Report* report = malloc(sizeof(*report));
+    long* days = malloc(sizeof(*days) * operations);
+    long long start;
+    long i;
+    int first;
+    int count;
+    int fd = open("/dev/null", O_WRONLY);
+
+    if (report != NULL && days != NULL && fd >= 0 && data->maxAppointments > 0)
+    {
+        for (i = 0; i < operations; i++)
+        {
+            days[i] = appointmentKeyDay(data->appointmentTimes[randomBelow(random, data->maxAppointments)]);
+        }
+
+        openReport(report, fd);
+        start = nowNanoseconds();
+
+        for (i = 0; i < operations; i++)
+        {
+            count = findAppointmentRange(data, days[i], days[i], &first);
+            result->checksum += reportSchedule(report, data, first, count, 0);
+        }
+
+        closeReport(report);
+        result->nanoseconds = nowNanoseconds() - start;
+        result->operations = operations;
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    free(report);
+    free(days);
+}
+
+// Renders the patient table and the full schedule, as --report does
+static void benchScheduleAll(struct BenchResult* result, const struct ClinicData* data)
+{
+    long long start = nowNanoseconds();
+
+    result->checksum = writeReport(data, "/dev/null");
+    result->nanoseconds = nowNanoseconds() - start;
+    result->operations = 1;
+}
+
+int main(int argc, char* argv[])
+{
+    struct ClinicData data = { 0 };
+    struct BenchResult results[] = {
+        { "import_patients", 0, 0, 0 }, { "import_appointments", 0, 0, 0 },
+        { "sort_appointments_shuffled", 0, 0, 0 }, { "sort_appointments_sorted", 0, 0, 0 },
+        { "find_patient_by_number", 0, 0, 0 }, { "find_phone", 0, 0, 0 },
+        { "slot_conflict", 0, 0, 0 }, { "find_booked_appointment", 0, 0, 0 },
+        { "schedule_day", 0, 0, 0 }, { "schedule_all", 0, 0, 0 }
+    };
+    const int count = (int)(sizeof(results) / sizeof(results[0]));
+    const char* directory = NULL;
+    char patientFile[4096];
+    char appointmentFile[4096];
+    unsigned long long random = 0x9E3779B97F4A7C15ull;
+    long operations = BENCH_DEFAULT_OPERATIONS;
+    long long start;
+    int threads = defaultImportThreads();
+    int status = 0;
+    int i;
+
+    // Options: --threads N import threads, --operations N lookups per benchmark, --seed N random keys
+    for (i = 1; i < argc && status == 0; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--operations") == 0 && i + 1 < argc && atol(argv[i + 1]) > 0)
+        {
+            operations = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc && strtoull(argv[i + 1], NULL, 10) > 0)
+        {
+            random = strtoull(argv[++i], NULL, 10);
+        }
+        else if (directory == NULL && strncmp(argv[i], "--", 2) != 0)
+        {
+            directory = argv[i];
+        }
+        else
+        {
+            status = 1;
+        }
+    }
+
+    if (status != 0 || directory == NULL)
+    {
+        printf("Usage: %s DIRECTORY [--threads N] [--operations N] [--seed N]\n", argv[0]);
+        status = 1;
+    }
+    else if (!initClinicData(&data, BENCH_INITIAL_PATIENTS, BENCH_INITIAL_APPOINTMENTS))
+    {
+        printf("ERROR: Not enough memory to run the benchmarks!\n");
+        status = 1;
+    }
+    else
+    {
+        snprintf(patientFile, sizeof(patientFile), "%s/patientData.txt", directory);
+        snprintf(appointmentFile, sizeof(appointmentFile), "%s/appointmentData.txt", directory);
+
+        start = nowNanoseconds();
+        results[0].operations = importPatientsParallel(patientFile, &data, threads);
+        results[0].nanoseconds = nowNanoseconds() - start;
+
+        start = nowNanoseconds();
+        results[1].operations = importAppointmentsParallel(appointmentFile, &data, threads);
+        results[1].nanoseconds = nowNanoseconds() - start;
+
+        benchSort(&results[2], &data, 0, &random);
+        benchSort(&results[3], &data, 1, &random);
+        benchPatientNumbers(&results[4], &data, operations, &random);
+        benchPhones(&results[5], &data, operations, &random);
+        benchConflicts(&results[6], &data, operations, 0, &random);
+        benchConflicts(&results[7], &data, operations, 1, &random);
+        benchScheduleDays(&results[8], &data, operations < BENCH_MAX_DAYS ? operations : BENCH_MAX_DAYS, &random);
+        benchScheduleAll(&results[9], &data);
+
+        printf("{\n  \"directory\": ");
+        printJsonString(directory);
+        printf(",\n  \"threads\": %d,\n  \"patients\": %d,\n  \"appointments\": %d,\n  \"results\": [\n",
+               threads, data.maxPatient, data.maxAppointments);
+
+        for (i = 0; i < count; i++)
+        {
+            printResult(&results[i], i == count - 1);
+        }
+
+        printf("  ]\n}\n");
+    }
+
+    freeClinicData(&data);
+
+    return status;
+}
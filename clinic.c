@@ -1,1106 +1,877 @@
 #define _CRT_SECURE_NO_WARNINGS
 
-#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-#include "core.h"
 #include "clinic.h"
+#include "index.h"
+#include "journal.h"
+#include "snapshot.h"
+#include "stats.h"
+
+
+// Phone descriptions by enum ContactType
+static const char* const contactNames[] = { "CELL", "HOME", "WORK", "TBD" };
 
 
 //////////////////////////////////////
-// DISPLAY FUNCTIONS
+// UTILITY FUNCTIONS
 //////////////////////////////////////
 
-// Display's the patient table header (table format)
-void displayPatientTableHeader(void)
+// Get the next highest patient number (removed numbers are not given out again while the data is loaded,
+// but the data files only keep the live patients, so after a restart the numbering goes on from the highest one)
+int nextPatientNumber(const struct ClinicData* data)
 {
-    printf("Pat.# Name            Phone#\n"
-           "----- --------------- --------------------\n");
+    // Kept up to date by storePatient, so adding a patient never scans the table
+    return data->lastPatientNumber + 1;
 }
 
-// Displays a single patient record in FMT_FORM | FMT_TABLE format
-void displayPatientData(const struct Patient* patient, int fmt)
+// Find the patient array index by patient number (returns -1 if not found)
+int findPatientIndexByPatientNum(int patientNumber, const struct ClinicData* data)
 {
-    if (fmt == FMT_FORM)
+    long long started = startStat();
+    int found = -1;
+    int i;
+
+    if (data->patientTable != NULL)
     {
-        printf("Name  : %s\n"
-               "Number: %05d\n"
-               "Phone : ", patient->name, patient->patientNumber);
-        displayFormattedPhone(patient->phone.number);
-        printf(" (%s)\n", patient->phone.description);
+        found = lookupPatient(data, patientNumber);
     }
-    else
+    else if (patientNumber != 0)
     {
-        printf("%05d %-15s ", patient->patientNumber,
-               patient->name);
-        displayFormattedPhone(patient->phone.number);
-        printf(" (%s)\n", patient->phone.description);
+        // No index (out of memory): scan the number column, stopping at the first match
+        for (i = 0; i < data->maxPatient && found == -1; i++)
+        {
+            if (data->patientNumbers[i] == patientNumber)
+            {
+                found = i;
+            }
+        }
     }
+
+    recordStat(STAT_PATIENT_LOOKUP, started);
+
+    return found;
 }
 
-// Display's appointment schedule headers (date-specific or all records)
-void displayScheduleTableHeader(const struct Date* date, int isAllRecords)
+// Gets the contact type of a phone description (returns -1 if it isn't CELL, HOME, WORK or TBD)
+int contactType(const char* description)
 {
-    printf("Clinic Appointments for the Date: ");
+    int type = CONTACT_TBD;
 
-    if (isAllRecords)
-    {
-        printf("<ALL>\n\n");
-        printf("Date       Time  Pat.# Name            Phone#\n"
-               "---------- ----- ----- --------------- --------------------\n");
-    }
-    else
+    while (type >= 0 && strcmp(contactNames[type], description) != 0)
     {
-        printf("%04d-%02d-%02d\n\n", date->year, date->month, date->day);
-        printf("Time  Pat.# Name            Phone#\n"
-               "----- ----- --------------- --------------------\n");
+        type--;
     }
+
+    return type;
 }
 
-// Display a single appointment record with patient info. in tabular format
-void displayScheduleData(const struct Patient* patient, const struct Appointment* appoint, int includeDateField)
+// Calculates the number of days from 0000-03-01 to the given date
+long dayNumber (int year, int month, int day)
 {
-    if (includeDateField)
+    long era;
+    long yearOfEra;
+    long dayOfYear;
+
+    // Counting years from March puts the leap day at the end of the year
+    if (month <= 2)
     {
-        printf("%04d-%02d-%02d ", appoint->date.year, appoint->date.month,
-               appoint->date.day);
+        year--;
     }
-    printf("%02d:%02d %05d %-15s ", appoint->time.hour, appoint->time.min,
-           patient->patientNumber, patient->name);
 
-    displayFormattedPhone(patient->phone.number);
+    era = year / 400;
+    yearOfEra = year - era * 400;
+    dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
 
-    printf(" (%s)\n", patient->phone.description);
+    return era * 146097 + yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
 }
 
+// Converts a day number (from dayNumber) back to a calendar date
+void dateFromDayNumber (long dayNum, struct Date *date)
+{
+    long era = dayNum / 146097;
+    long dayOfEra = dayNum - era * 146097;
+    long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long monthIndex = (5 * dayOfYear + 2) / 153;
+
+    date->day = (int)(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    date->month = (int)(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    date->year = (int)(yearOfEra + era * 400 + (date->month <= 2));
+}
 
-//////////////////////////////////////
-// MENU & ITEM SELECTION FUNCTIONS
-//////////////////////////////////////
+// Packs an appointment's date and time into one 32-bit key (minutes since APPOINTMENT_FIRST_YEAR began)
+unsigned int appointmentKey (const struct Appointment *appoint)
+{
+    long day = dayNumber(appoint->date.year, appoint->date.month, appoint->date.day) -
+               dayNumber(APPOINTMENT_FIRST_YEAR, 1, 1);
+
+    return (unsigned int)day * MINUTES_PER_DAY + appoint->time.hour * 60 + appoint->time.min;
+}
 
-// main menu
-void menuMain(struct ClinicData* data)
+// Gets the day number (see dayNumber) of a packed appointment key
+long appointmentKeyDay (unsigned int key)
 {
-    int selection;
-
-    do {
-        printf("Veterinary Clinic System\n"
-               "=========================\n"
-               "1) PATIENT     Management\n"
-               "2) APPOINTMENT Management\n"
-               "-------------------------\n"
-               "0) Exit System\n"
-               "-------------------------\n"
-               "Selection: ");
-        selection = inputIntRange(0, 2);
-        putchar('\n');
-        switch (selection)
-        {
-            case 0:
-                printf("Are you sure you want to exit? (y|n): ");
-                selection = !(inputCharOption("yn") == 'y');
-                putchar('\n');
-                if (!selection)
-                {
-                    printf("Exiting system... Goodbye.\n\n");
-                }
-                break;
-            case 1:
-                menuPatient(data->patients, data->maxPatient);
-                break;
-            case 2:
-                menuAppointment(data);
-                break;
-        }
-    } while (selection);
+    return (long)(key / MINUTES_PER_DAY) + dayNumber(APPOINTMENT_FIRST_YEAR, 1, 1);
 }
 
-// Menu: Patient Management
-void menuPatient(struct Patient patient[], int max)
+// Unpacks an appointment key back into the appointment's date and time
+void appointmentFromKey (unsigned int key, struct Appointment *appoint)
 {
-    int selection;
-
-    do {
-        printf("Patient Management\n"
-               "=========================\n"
-               "1) VIEW   Patient Data\n"
-               "2) SEARCH Patients\n"
-               "3) ADD    Patient\n"
-               "4) EDIT   Patient\n"
-               "5) REMOVE Patient\n"
-               "-------------------------\n"
-               "0) Previous menu\n"
-               "-------------------------\n"
-               "Selection: ");
-        selection = inputIntRange(0, 5);
-        putchar('\n');
-        switch (selection)
-        {
-            case 1:
-                displayAllPatients(patient, max, FMT_TABLE);
-                suspend();
-                break;
-            case 2:
-                searchPatientData(patient, max);
-                break;
-            case 3:
-                addPatient(patient, max);
-                suspend();
-                break;
-            case 4:
-                editPatient(patient, max);
-                break;
-            case 5:
-                removePatient(patient, max);
-                suspend();
-                break;
-        }
-    } while (selection);
+    int minute = (int)(key % MINUTES_PER_DAY);
+
+    dateFromDayNumber(appointmentKeyDay(key), &appoint->date);
+    appoint->time.hour = minute / 60;
+    appoint->time.min = minute % 60;
 }
 
-// Menu: Patient edit
-void menuPatientEdit(struct Patient* patient)
+// Radix sorts the appointment columns by their packed key (used after an import)
+void sortAppointments (int *patients, unsigned int *times, int max)
 {
-    int selection;
+    int i;
+    int shift;
+    int counts[256];
+    int total;
+    int bucket;
+    int *patientBuffer = NULL;
+    unsigned int *timeBuffer = NULL;
+    int *patientSource = patients;
+    int *patientTarget;
+    unsigned int *timeSource = times;
+    unsigned int *timeTarget;
+    int patient;
+    unsigned int time;
+    long long started = startStat();
+    int sorted = 1;
 
-    do {
-        printf("Edit Patient (%05d)\n"
-               "=========================\n"
-               "1) NAME : %s\n"
-               "2) PHONE: ", patient->patientNumber, patient->name);
+    // Exported files are already in order, so most imports skip the sort
+    for (i = 1; i < max && sorted; i++)
+    {
+        sorted = times[i - 1] <= times[i];
+    }
 
-        displayFormattedPhone(patient->phone.number);
+    if (!sorted)
+    {
+        patientBuffer = malloc(sizeof(*patientBuffer) * max);
+        timeBuffer = malloc(sizeof(*timeBuffer) * max);
+    }
 
-        printf("\n"
-               "-------------------------\n"
-               "0) Previous menu\n"
-               "-------------------------\n"
-               "Selection: ");
-        selection = inputIntRange(0, 2);
-        putchar('\n');
+    if (patientBuffer != NULL && timeBuffer != NULL)
+    {
+        patientTarget = patientBuffer;
+        timeTarget = timeBuffer;
 
-        if (selection == 1)
-        {
-            printf("Name  : ");
-            inputCString(patient->name, 1, NAME_LEN, 0);
-            putchar('\n');
-            printf("Patient record updated!\n\n");
-        }
-        else if (selection == 2)
+        // Stable LSD radix sort, one byte per pass. Passes where every key shares the same
+        // byte are skipped, so dates only pay for the handful of bytes they actually use.
+        for (shift = 0; shift < 32; shift += 8)
         {
-            inputPhoneData(&patient->phone);
-            printf("\nPatient record updated!\n\n");
-        }
+            memset(counts, 0, sizeof(counts));
 
-    } while (selection);
-}
+            for (i = 0; i < max; i++)
+            {
+                counts[(timeSource[i] >> shift) & 0xFF]++;
+            }
 
+            if (counts[(timeSource[0] >> shift) & 0xFF] != max)
+            {
+                for (i = 0, total = 0; i < 256; i++)
+                {
+                    bucket = counts[i];
+                    counts[i] = total;
+                    total += bucket;
+                }
 
-// Menu: Appointment Management
-void menuAppointment(struct ClinicData* data)
-{
-    int selection;
-
-    do {
-        printf("Appointment Management\n"
-               "==============================\n"
-               "1) VIEW   ALL Appointments\n"
-               "2) VIEW   Appointments by DATE\n"
-               "3) ADD    Appointment\n"
-               "4) REMOVE Appointment\n"
-               "------------------------------\n"
-               "0) Previous menu\n"
-               "------------------------------\n"
-               "Selection: ");
-        selection = inputIntRange(0, 4);
-        putchar('\n');
-        switch (selection)
-        {
-            case 1:
-                viewAllAppointments(data);
-                suspend();
-                break;
-            case 2:
-                viewAppointmentSchedule(data);
-                suspend();
-                break;
-            case 3:
-                addAppointment(data->appointments, data->maxAppointments,
-                               data->patients, data->maxPatient);  // ToDo: You will need to create this function!
-                suspend();
-                break;
-            case 4:
-                removeAppointment(data->appointments, data->maxAppointments,
-                                  data->patients, data->maxPatient);  // ToDo: You will need to create this function!
-                suspend();
-                break;
-        }
-    } while (selection);
-}
+                for (i = 0; i < max; i++)
+                {
+                    bucket = counts[(timeSource[i] >> shift) & 0xFF]++;
+                    timeTarget[bucket] = timeSource[i];
+                    patientTarget[bucket] = patientSource[i];
+                }
 
-// Display's all patient data in the FMT_FORM | FMT_TABLE format
-void displayAllPatients(const struct Patient patient[], int max, int fmt)
-{
-    int i = 0;
-    int patients = 0;
+                patientTarget = patientSource;
+                patientSource = patientTarget == patients ? patientBuffer : patients;
+                timeTarget = timeSource;
+                timeSource = timeTarget == times ? timeBuffer : times;
+            }
+        }
 
-    if (fmt == FMT_TABLE)
-    {
-        displayPatientTableHeader();
-        for (i = 0; i < max; i++)
+        if (timeSource != times)
         {
-            if(patient[i].patientNumber != 0)
-            {
-                displayPatientData(&patient[i], fmt);
-                patients++;
-            }
+            memcpy(patients, patientSource, sizeof(*patients) * max);
+            memcpy(times, timeSource, sizeof(*times) * max);
         }
     }
-    else if (fmt == FMT_FORM)
+    else if (!sorted)
     {
-        for (i = 0; i < max; i++)
+        // Out of memory: fall back to an in-place insertion sort on the same key
+        for (i = 1; i < max; i++)
         {
-            if(patient[i].patientNumber != 0)
+            patient = patients[i];
+            time = times[i];
+
+            for (bucket = i; bucket > 0 && times[bucket - 1] > time; bucket--)
             {
-                displayPatientData(&patient[i], fmt);
-                patients++;
+                patients[bucket] = patients[bucket - 1];
+                times[bucket] = times[bucket - 1];
             }
+
+            patients[bucket] = patient;
+            times[bucket] = time;
         }
     }
 
-    if (patients == 0)
-    {
-        printf("\n*** No records found ***\n");
-    }
+    free(patientBuffer);
+    free(timeBuffer);
 
-    printf("\n");
+    recordStat(STAT_SORT, started);
 }
 
-// Search for a patient record based on patient number or phone number
-void searchPatientData(const struct Patient patient[], int max)
+// Inserts an appointment at its sorted position, returns the index (-1 if out of memory)
+int insertAppointment (struct ClinicData *data, const struct Appointment *appoint)
 {
-    int selection = 0;
+    long long started = startStat();
+    int count = data->maxAppointments;
+    int index = -1;
+    unsigned int key = appointmentKey(appoint);
 
-    do
+    if (reserveAppointments(data, count + 1))
     {
-        printf("Search Options\n");
-        printf("==========================\n");
-        printf("1) By patient number\n");
-        printf("2) By phone number\n");
-        printf("..........................\n");
-        printf("0) Previous menu\n");
-        printf("..........................\n");
-        printf("Selection: ");
-        selection = inputIntRange(0, 2);
-
-        switch (selection)
-        {
-            case 1:
-                putchar('\n');
-                searchPatientByPatientNumber(patient, max);
-                suspend();
-                break;
-            case 2:
-                searchPatientByPhoneNumber(patient, max);
-                suspend();
-                break;
-            default:
-                putchar('\n');
-                break;
-        }
+        // Upper bound, so appointments with an equal key keep their booking order
+        index = searchAppointmentKey(data, key, 1);
 
-    } while (selection);
-}
+        memmove(&data->appointmentPatients[index + 1], &data->appointmentPatients[index],
+                sizeof(*data->appointmentPatients) * (count - index));
+        memmove(&data->appointmentTimes[index + 1], &data->appointmentTimes[index],
+                sizeof(*data->appointmentTimes) * (count - index));
+        data->appointmentPatients[index] = appoint->patientNum;
+        data->appointmentTimes[index] = key;
 
-// Add a new patient record to the patient array
-void addPatient(struct Patient patient[], int max)
-{
-    int i = 0;
-    int flag = 0;
-    int index = 0;
-    int notFound = 0;
+        data->maxAppointments++;
 
-    notFound = 0;
+        markSlot(data, appoint);
+    }
 
-    while(flag == 0)
-    {
-        if (i >= max)
-        {
-            notFound = 1;
-            flag = 1;
-        }
-        else if(patient[i].patientNumber == 0000)
-        {
-            index = i;
-            flag = 1;
-        }
-        i++;
-    };
+    recordStat(STAT_BOOKING, started);
 
-    if(notFound == 1)
-    {
-        printf("ERROR: Patient listing is FULL!\n\n");
-    }
-    else
-    {
-        patient[index].patientNumber = nextPatientNumber(patient, max);
-        inputPatient(&patient[index]);
-        printf("\n*** New patient record added ***\n\n");
-    }
+    return index;
 }
 
-// Edit a patient record from the patient array
-void editPatient(struct Patient patient[], int max)
+// Removes the appointment at the index, shifting later appointments down to keep the order
+void deleteAppointment (struct ClinicData *data, int index)
 {
-    int index;
-    int patientNumber;
-    printf("Enter the patient number: ");
-    patientNumber = inputInt();
-    putchar('\n');
+    int count = data->maxAppointments;
+    long day;
 
-    index = findPatientIndexByPatientNum(patientNumber, patient, max);
-
-    if (index >= 0)
+    if (index >= 0 && index < count)
     {
-        menuPatientEdit(&patient[index]);
-    }
-    else
-    {
-        printf("\nERROR: Patient record not found!\n\n");
-    }
-
-}
+        day = appointmentKeyDay(data->appointmentTimes[index]);
 
+        memmove(&data->appointmentPatients[index], &data->appointmentPatients[index + 1],
+                sizeof(*data->appointmentPatients) * (count - index - 1));
+        memmove(&data->appointmentTimes[index], &data->appointmentTimes[index + 1],
+                sizeof(*data->appointmentTimes) * (count - index - 1));
 
-// Remove a patient record from the patient array
-void removePatient(struct Patient patient[], int max)
-{
-    const int FMT = FMT_FORM;
-    int patientNumber = 0;
-    int recordExists = 0;
-    char confirmation;
-    const struct Patient EmptyState = {0};
+        data->maxAppointments--;
 
-    printf("Enter the patient number: ");
-    patientNumber = inputInt();
-    putchar('\n');
+        refreshSlots(data, day);
+    }
+}
 
-    recordExists = findPatientIndexByPatientNum(patientNumber, patient, max);
+// Gets the number of days in the month (accounts for leap year)
+int daysInMonth (int year, int month)
+{
+    int days = 0;
 
-    if (recordExists >= 0)
+    if (month == 2)
     {
-        displayPatientData(&patient[recordExists], FMT);
-
-        putchar('\n');
-
-        printf("Are you sure you want to remove this patient record? (y/n): ");
-        confirmation = inputCharOption("yn");
-
-        if(confirmation == 'n')
+        if ( ((year % 4 == 0) && (year % 100 != 0)) || year % 400 == 0)
         {
-            printf("Operation aborted.\n\n");
+            days = 29;
         }
         else
         {
-            patient[recordExists] = EmptyState;
-
-            printf("Patient record has been removed!\n\n");
+            days = 28;
         }
     }
+    else if (month == 1 || month == 3 || month == 5 || month == 7 || month == 8 || month == 10 || month == 12)
+    {
+        days = 31;
+    }
     else
     {
-        printf("ERROR: Patient record not found!\n\n");
+        days = 30;
     }
+
+    return days;
 }
 
-// View ALL scheduled appointments
-void viewAllAppointments(struct ClinicData* data)
+// Finds the patient's appointment among count appointments starting at first, returns its index (-1 if none)
+int findAppointment (const struct ClinicData *data, int patientNumber, int first, int count)
 {
-    int i = 0;
-    int j = 0;
-    int isAllRecords = 1;
-    int includeDateField = 1;
-
-    sortAppointments(data->appointments, data->maxPatient);
-
-    displayScheduleTableHeader(&data->appointments->date, isAllRecords);
+    int index = -1;
+    int i;
 
-    for (i = 0; i < data->maxAppointments; i++)
+    // Only the patient column is read, the date range was already narrowed down by the caller
+    for (i = first; i < first + count && index == -1; i++)
     {
-        for (j = 0; j < data->maxPatient; j++)
+        if (data->appointmentPatients[i] == patientNumber)
         {
-            if (data->appointments[i].patientNum == data->patients[j].patientNumber)
-            {
-                displayScheduleData(&data->patients[j], &data->appointments[i], includeDateField);
-            }
+            index = i;
         }
     }
 
-    putchar('\n');
-
+    return index;
 }
 
-// View appointment schedule for the user input date
-void viewAppointmentSchedule (struct ClinicData *data)
+
+//////////////////////////////////////
+// CLINIC OPERATIONS
+//////////////////////////////////////
+
+// Checks the phone the menus would allow: a known description, and 10 digits unless it is TBD
+static int validPhone(const struct Phone* phone)
 {
+    int type = contactType(phone->description);
 
-    // Loop Vars
-    int i;
-    int j;
-    int counter = 0;
+    return type == CONTACT_TBD ? phone->number[0] == '\0' : type != -1 && packPhone(phone->number) != PHONE_NONE;
+}
 
-    // Temp Struct
-    struct Appointment temp;
+// Checks that the date is on the calendar (any year from 1)
+static int validDate(const struct Date* date)
+{
+    return date->year > 0 && date->month >= 1 && date->month <= 12 &&
+           date->day >= 1 && date->day <= daysInMonth(date->year, date->month);
+}
 
-    // Get user input for year
-    printf("Year        : ");
-    temp.date.year = inputIntPositive();
+// Gets the text of a result, as the batch commands report it
+const char* clinicResultMessage(enum ClinicResult result)
+{
+    static const char* const messages[] = {
+        "OK", "Malformed patient record", "Malformed appointment record", "Patient record not found",
+        "No appointment at that date and time", "Time is not a bookable timeslot",
+        "Appointment timeslot is not available", "Not enough memory"
+    };
 
-    // Get user input for month
-    printf("Month (1-12): ");
-    temp.date.month = inputIntRange(1, 12);
+    return messages[result];
+}
 
-    // Calculates and gets user input for day
-    setDay(&temp.date.day, temp.date.year, temp.date.month);
+// Gets the patient by number (returns CLINIC_OK or CLINIC_NOT_FOUND)
+enum ClinicResult clinicFindPatient(const struct ClinicData* data, int patientNumber, struct Patient* patient)
+{
+    int index = findPatientIndexByPatientNum(patientNumber, data);
 
-    putchar('\n');
+    if (index != -1)
+    {
+        patientAt(data, index, patient);
+    }
 
-    displayScheduleTableHeader(&temp.date, TRUE);
+    return index != -1 ? CLINIC_OK : CLINIC_NOT_FOUND;
+}
 
-    sortAppointments(data->appointments, data->maxAppointments);
+// Adds the patient under the next patient number, which is set in the record
+// (returns CLINIC_OK, CLINIC_BAD_PATIENT or CLINIC_FULL)
+enum ClinicResult clinicAddPatient(struct ClinicData* data, struct Patient* patient)
+{
+    enum ClinicResult result = CLINIC_BAD_PATIENT;
+    struct Patient added = *patient;
+    int index = -1;
 
-    for (i = 0; i < data->maxAppointments; i++)
+    if (validPhone(&patient->phone))
     {
-        for (j = 0; j < data->maxPatient; j++)
-        {
-            if (data->appointments[i].patientNum == data->patients[j].patientNumber)
-            {
-                if (data->appointments[i].date.year == temp.date.year && data->appointments[i].date.month == temp.date.month && data->appointments[i].date.day == temp.date.day)
-                {
-                    displayScheduleData(&data->patients[j], &data->appointments[i], TRUE);
-                    counter++;
-                }
-            }
-        }
+        // New patients go after the last one, removals keep the table without gaps
+        index = allocatePatient(data);
+        result = CLINIC_FULL;
     }
 
-    if (counter == 0)
+    if (index != -1)
     {
-        printf("\n*** No records found ***\n");
-    }
+        added.patientNumber = nextPatientNumber(data);
 
-    putchar('\n');
+        // The caller's record only gets the number once the patient is stored
+        if (storePatient(data, index, &added))
+        {
+            indexPatient(data, index);
+            journalPatient(data, '+', &added);
+            patient->patientNumber = added.patientNumber;
+            result = CLINIC_OK;
+        }
+        else
+        {
+            releasePatient(data, index);
+        }
+    }
 
+    return result;
 }
 
-// Add an appointment record to the appointment array
-void addAppointment (struct Appointment *appointments, int maxAppointments, struct Patient *patients, int maxPatient)
+// Replaces the name and phone of the patient with the record's number
+// (returns CLINIC_OK, CLINIC_BAD_PATIENT, CLINIC_NOT_FOUND or CLINIC_FULL)
+enum ClinicResult clinicEditPatient(struct ClinicData* data, const struct Patient* patient)
 {
-    // Loop Vars
-    int flag = 0;
-    int i;
-
-    // Used to get the return value from function
-    int appointmentInputted;
-
-    // Vars used to calculate the empty index of the struct arrays
-    int patientIndex = -1;
-    int appointmentIndex = -1;
-
-    // Used to recieve the number of appointments
-    int numAppointments = 0;
-
-    // Struct used to recieve data, gets assigned later.
-    struct Appointment added;
+    enum ClinicResult result = CLINIC_BAD_PATIENT;
+    int index = -1;
 
-    // Calculating number of filled appointments, and find empty position
-    numberOfAppointments(appointments, maxAppointments, &numAppointments);
-    appointmentIndex = findEmptyAppointment(appointments, maxAppointments);
+    if (validPhone(&patient->phone))
+    {
+        index = findPatientIndexByPatientNum(patient->patientNumber, data);
+        result = CLINIC_NOT_FOUND;
+    }
 
-    if (numAppointments < maxAppointments && appointmentIndex >= 0)
+    if (index != -1)
     {
+        unindexPhone(data, index);
+        unindexName(data, index);
+        result = storePatient(data, index, patient) ? CLINIC_OK : CLINIC_FULL;
+        indexPhone(data, index);
+        indexName(data, index);
 
-        do
+        if (result == CLINIC_OK)
         {
-            printf("Patient Number: ");
-            added.patientNum = inputIntPositive();
-            patientIndex = findPatientIndexByPatientNum(added.patientNum, patients, maxPatient);
-
-            if (patientIndex == -1)
-            {
-                printf("ERROR: Patient record not found!\n\n");
-            }
-            else
-            {
-                flag = 1;
-            }
-
-        } while (flag == 0);
+            journalPatient(data, '=', patient);
+        }
+    }
 
+    return result;
+}
 
-        // Once the loop above gets terminated, the same flag variable is used in the condition.
+// Removes the patient by number, removed gets the record (returns CLINIC_OK or CLINIC_NOT_FOUND)
+enum ClinicResult clinicRemovePatient(struct ClinicData* data, int patientNumber, struct Patient* removed)
+{
+    int index = findPatientIndexByPatientNum(patientNumber, data);
 
-        while (flag == 1)
-        {
-            // Function return's 1, once inputs have been completed
-            appointmentInputted = inputAppointment(&added);
+    if (index != -1)
+    {
+        patientAt(data, index, removed);
 
-            if (appointmentInputted == 1)
-            {
-                for (i = 0; i < maxAppointments; i++)
-                {
+        unindexPatient(data, index);
+        releasePatient(data, index);
+        journalPatient(data, '-', removed);
+    }
 
-                    if (added.date.year == appointments[i].date.year &&
-                        added.date.month == appointments[i].date.month &&
-                        added.date.day == appointments[i].date.day &&
-                        added.time.hour == appointments[i].time.hour &&
-                        added.time.min == appointments[i].time.min)
-                    {
-                        printf("\nERROR: Appointment timeslot is not available!\n\n");
-                        flag = 1;
-                    }
-                    else if (added.date.year != appointments[i].date.year &&
-                             added.date.month != appointments[i].date.month &&
-                             added.date.day != appointments[i].date.day &&
-                             added.time.hour != appointments[i].time.hour &&
-                             added.time.min != appointments[i].time.min)
-                    {
-                        flag = 0;
-                    }
-                }
-            }
-        }
+    return index != -1 ? CLINIC_OK : CLINIC_NOT_FOUND;
+}
 
-        // Using the same flag variable, if the above else if condition is true the loop is terminated by setting flag to zero.
-        // This conditon now checks the flag variable and assigns the appointment index to the temporary input struct.
+// Books the appointment, suggested gets the next free timeslot when it is taken (may be NULL)
+// (returns CLINIC_OK, CLINIC_BAD_APPOINTMENT, CLINIC_NOT_FOUND, CLINIC_BAD_TIME, CLINIC_SLOT_TAKEN or CLINIC_FULL)
+enum ClinicResult clinicAddAppointment(struct ClinicData* data, const struct Appointment* appoint,
+                                       struct Appointment* suggested)
+{
+    enum ClinicResult result = CLINIC_OK;
 
-        if (flag == 0)
+    if (!validDate(&appoint->date) ||
+        appoint->date.year < APPOINTMENT_FIRST_YEAR || appoint->date.year > APPOINTMENT_LAST_YEAR)
+    {
+        result = CLINIC_BAD_APPOINTMENT;
+    }
+    else if (findPatientIndexByPatientNum(appoint->patientNum, data) == -1)
+    {
+        result = CLINIC_NOT_FOUND;
+    }
+    else if (appointmentSlot(appoint) == -1)
+    {
+        result = CLINIC_BAD_TIME;
+    }
+    else if (isSlotTaken(data, appoint))
+    {
+        // The timeslot bitmaps make the check, and the search for a free one, constant time
+        if (suggested != NULL)
         {
-            appointments[appointmentIndex] = added;
-            printf("\n*** Appointment scheduled! ***\n\n");
+            *suggested = *appoint;
+            findNextFreeSlot(data, suggested);
         }
+
+        result = CLINIC_SLOT_TAKEN;
+    }
+    else if (insertAppointment(data, appoint) == -1)
+    {
+        result = CLINIC_FULL;
     }
     else
     {
-        printf("\nERROR: Appointments are full, please contact us to book an appointment!\n");
+        journalAppointment(data, '+', appoint);
     }
 
-    clearInputBuffer();
-
+    return result;
 }
 
-// Remove an appointment record from the appointment array
-void removeAppointment (struct Appointment *appointments, int maxAppointments, struct Patient *patients, int maxPatient)
+// Gets the patient's appointment on the date (returns CLINIC_OK, CLINIC_NOT_FOUND or CLINIC_NO_APPOINTMENT)
+enum ClinicResult clinicFindAppointment(const struct ClinicData* data, int patientNumber, const struct Date* date,
+                                        struct Appointment* appoint)
 {
-    // Loop Vars
-    int patientIndex = -1;
+    enum ClinicResult result = CLINIC_NOT_FOUND;
+    long day;
+    int first = 0;
+    int count = 0;
     int index = -1;
 
-    // Used to get the return value from function
-    int year = 0;
-    int month = 0;
-    int day = 0;
-    int patientNumber = 0;
-    char selection;
-
-    // Empty struct used to set to zero
-    struct Appointment empty = {0};
-
-        printf("Patient Number: ");
-        scanf("%d", &patientNumber);
+    if (findPatientIndexByPatientNum(patientNumber, data) != -1)
+    {
+        // Finds the day's appointments with the calendar index, then the patient's appointment among them
+        if (validDate(date))
+        {
+            day = dayNumber(date->year, date->month, date->day);
+            count = findAppointmentRange(data, day, day, &first);
+            index = findAppointment(data, patientNumber, first, count);
+        }
 
-        patientIndex = findPatientIndexByPatientNum(patientNumber, patients, maxPatient);
+        result = CLINIC_NO_APPOINTMENT;
+    }
 
-        if (patientIndex > -1)
-        {
-            // Get user input for year
-            printf("Year        : ");
-            year = inputIntPositive();
+    if (index != -1)
+    {
+        appointmentAt(data, index, appoint);
+        result = CLINIC_OK;
+    }
 
-            // Get user input for month
-            printf("Month (1-12): ");
-            month = inputIntRange(1, 12);
+    return result;
+}
 
-            // Calculates and gets user input for day
-            setDay(&day, year, month);
+// Cancels the appointment booked at exactly its date and time (returns CLINIC_OK or CLINIC_NO_APPOINTMENT)
+enum ClinicResult clinicRemoveAppointment(struct ClinicData* data, const struct Appointment* appoint)
+{
+    int index = findBookedAppointment(data, appoint);
 
-            putchar('\n');
+    if (index != -1)
+    {
+        deleteAppointment(data, index);
+        journalAppointment(data, '-', appoint);
+    }
 
-            // Display the patient's data
-            displayPatientData(&patients[patientIndex], FALSE);
+    return index != -1 ? CLINIC_OK : CLINIC_NO_APPOINTMENT;
+}
 
-            // Iterates through appointment struct array to find the appointment, and saves appointment in index
-            index = findAppointment(appointments, patientNumber, year, month, day, maxAppointments);
+// Gets the appointments from one date to another, inclusive (both NULL = all of them): the index of the
+// first one and how many there are, in time order (returns CLINIC_OK or CLINIC_BAD_APPOINTMENT)
+enum ClinicResult clinicSchedule(const struct ClinicData* data, const struct Date* from, const struct Date* to,
+                                 int* first, int* count)
+{
+    enum ClinicResult result = CLINIC_OK;
+    long firstDay;
+    long lastDay;
 
+    *first = 0;
+    *count = data->maxAppointments;
 
-            if (index != -1)
-            {
-                printf("Are you sure you want to remove this appointment (y,n): ");
-                selection = inputCharOption("yn");
+    if (from != NULL && to != NULL)
+    {
+        firstDay = dayNumber(from->year, from->month, from->day);
+        lastDay = dayNumber(to->year, to->month, to->day);
 
-                if (selection == 'y' || selection == 'Y')
-                {
-                    appointments[index] = empty;
-                    printf("\nAppointment record has been removed!\n\n");
-                }
-                else
-                {
-                    printf("\n*** Operation Aborted! ***\n\n");
-                }
-            }
-            else
-            {
-                printf("\n*** No Appointments with that date! ***\n\n");
-            }
+        if (validDate(from) && validDate(to) && firstDay <= lastDay)
+        {
+            *count = findAppointmentRange(data, firstDay, lastDay, first);
         }
         else
         {
-            printf("ERROR: Patient record not found!\n\n");
-            clearInputBuffer();
+            *count = 0;
+            result = CLINIC_BAD_APPOINTMENT;
         }
+    }
+
+    return result;
 }
 
+
 //////////////////////////////////////
-// UTILITY FUNCTIONS
+// DATA FUNCTIONS
 //////////////////////////////////////
 
-// Search and display patient record by patient number (form)
-void searchPatientByPatientNumber(const struct Patient patient[], int max)
+// Grows an array to hold at least the number of elements, doubling its capacity (returns 1 on success)
+static int growArray(const struct ClinicData* data, void** array, int* capacity, int needed, size_t elementSize)
 {
-    const int FMT = FMT_FORM;
-    int patientNumber = 0;
-    int value = 0;
-
-    printf("Search by patient number: ");
-    patientNumber = inputInt();
+    int newCapacity = *capacity > 0 ? *capacity : 16;
+    void* grown = *array;
 
-    value = findPatientIndexByPatientNum(patientNumber, patient, max);
-
-    if(value >= 0)
+    while (newCapacity < needed)
     {
-        putchar('\n');
-        displayPatientData(&patient[value], FMT);
-        putchar('\n');
+        newCapacity *= 2;
     }
-    else
+
+    if (newCapacity != *capacity)
     {
-        printf("\n*** No records found ***\n\n");
+        grown = resizeData(data, *array, elementSize * *capacity, elementSize * newCapacity);
+
+        if (grown != NULL)
+        {
+            // New rows start out empty (patient number 0 / year 0)
+            memset((char*)grown + elementSize * *capacity, 0, elementSize * (newCapacity - *capacity));
+            *array = grown;
+            *capacity = newCapacity;
+        }
     }
-}
 
+    return grown != NULL;
+}
 
-// Search and display patient records by phone number (tabular)
-void searchPatientByPhoneNumber(const struct Patient patient[], int max)
+// Copies the patients' names to a new arena, dropping the replaced ones (returns 1 on success)
+static int compactNames(struct ClinicData* data)
 {
-    const int FMT = FMT_TABLE;
-    char phoneNumber[PHONE_LEN + 1]; // +1 is to accommodate for the NULL terminator
+    char* arena = malloc(data->nameArenaCapacity);
+    int used = 0;
+    int length;
     int i;
-    int found;
-
-    printf("\nSearch by phone number: ");
-    inputCString(phoneNumber, 10, 10, 0); // Only accepts up till 10 chars for the number.
-
-    putchar('\n');
-
-    displayPatientTableHeader();
 
-    found = 0; // Resets found counter
-
-    for (i = 0; i < max; i++)
+    if (arena != NULL)
     {
-        if(strcmp(patient[i].phone.number, phoneNumber) == 0) // Compares index'd struct's phone number to entered phone number.
+        for (i = 0; i < data->maxPatient; i++)
         {
-            displayPatientData(&patient[i], FMT);
-            found++;
+            length = (int)strlen(patientName(data, i)) + 1;
+            memcpy(arena + used, patientName(data, i), length);
+            data->patientNames[i] = used;
+            used += length;
         }
-    }
-    putchar('\n');
 
-    if(found == 0)
-    {
-        printf("*** No records found ***\n\n");
+        releaseData(data, data->nameArena);
+        data->nameArena = arena;
+        data->nameArenaUsed = used;
+        data->nameArenaFree = 0;
     }
+
+    return arena != NULL;
 }
 
-// Get the next highest patient number
-int nextPatientNumber(const struct Patient patient[], int max)
+// Stores a name for the patient slot, over its current name when the new one fits (returns 1 on success)
+static int storeName(struct ClinicData* data, int index, const char* name)
 {
-    int i;
-    int biggest = patient[0].patientNumber;
+    int length = (int)strlen(name) + 1;
+    int current = (int)strlen(patientName(data, index)) + 1;
+    int stored = 1;
 
-    for (i = 0; i < max; i++)
+    if (data->patientNumbers[index] != 0 && length <= current)
     {
-        if(patient[i].patientNumber > biggest)
+        memcpy(data->nameArena + data->patientNames[index], name, length);
+        data->nameArenaFree += current - length;
+    }
+    else
+    {
+        // Compact once most of the arena is replaced names, rather than growing it further
+        if (data->nameArenaFree > data->nameArenaUsed / 2 && data->nameArenaUsed + length > data->nameArenaCapacity)
+        {
+            compactNames(data);
+        }
+
+        stored = growArray(data, (void**)&data->nameArena, &data->nameArenaCapacity, data->nameArenaUsed + length, 1);
+
+        if (stored)
         {
-            biggest = patient[i].patientNumber;
+            // A live patient's old name is left behind
+            if (data->patientNumbers[index] != 0)
+            {
+                data->nameArenaFree += current;
+            }
+
+            memcpy(data->nameArena + data->nameArenaUsed, name, length);
+            data->patientNames[index] = data->nameArenaUsed;
+            data->nameArenaUsed += length;
         }
     }
 
-    biggest += 1;
+    return stored;
+}
 
-    return biggest;
+// Sets up empty patient/appointment tables with room for the given number of rows (returns 1 on success)
+int initClinicData(struct ClinicData* data, int patientCapacity, int appointmentCapacity)
+{
+    const struct ClinicData empty = {0};
+
+    *data = empty;
+
+    return reservePatients(data, patientCapacity) && reserveAppointments(data, appointmentCapacity);
 }
 
-// Find the patient array index by patient number (returns -1 if not found)
-int findPatientIndexByPatientNum(int patientNumber, const struct Patient patient[], int max)
+// Releases the tables and every index owned by the ClinicData
+void freeClinicData(struct ClinicData* data)
 {
-    int i;
-    int found = 0;
-    int counter;
+    const struct ClinicData empty = {0};
 
-    counter = 0;
+    freePatientIndex(data);
+    freeSlotIndex(data);
 
-    for (i = 0; i < max; i++)
-    {
-        if (patient[i].patientNumber == patientNumber)
-        {
-            found = i;
-            counter++;
-        }
-    }
+    releaseData(data, data->patientNumbers);
+    releaseData(data, data->patientPhones);
+    releaseData(data, data->patientContacts);
+    releaseData(data, data->patientNames);
+    releaseData(data, data->nameArena);
+    releaseData(data, data->appointmentPatients);
+    releaseData(data, data->appointmentTimes);
 
-    if (counter == 0)
-    {
-        found = -1;
-    }
+    // Nothing points into the snapshot any more
+    unloadSnapshot(data);
 
-    return found;
+    *data = empty;
 }
 
-// Bubble sorts appointments by year, month, day, hour, and minute
-void sortAppointments (struct Appointment *appointments, int max)
+// Checks if the block is part of the loaded snapshot rather than the heap
+static int isSnapshotData(const struct ClinicData* data, const void* block)
 {
-    int i;
-    int j;
-    struct Appointment temp;
-
-    for (i = 0; i < max - 1; i++)
-    {
-        for (j = i+1; j < max - 1; j++)
-        {
-            if (appointments[i].date.year != 0000 && appointments[j].date.year != 0000)
-            {
-                if (appointments[i].date.year > appointments[j].date.year)
-                {
-                    temp = appointments[i];
-                    appointments[i] = appointments[j];
-                    appointments[j] = temp;
-                }
-                else if (appointments[i].date.year == appointments[j].date.year)
-                {
-                    if (appointments[i].date.month > appointments[j].date.month)
-                    {
-                        temp = appointments[i];
-                        appointments[i] = appointments[j];
-                        appointments[j] = temp;
-                    }
-                    else if (appointments[i].date.month == appointments[j].date.month)
-                    {
-                        if (appointments[i].date.day > appointments[j].date.day)
-                        {
-                            temp = appointments[i];
-                            appointments[i] = appointments[j];
-                            appointments[j] = temp;
-                        }
-                        else if (appointments[i].date.day == appointments[j].date.day)
-                        {
-                            if (appointments[i].time.hour > appointments[j].time.hour)
-                            {
-                                temp = appointments[i];
-                                appointments[i] = appointments[j];
-                                appointments[j] = temp;
-                            }
-                            else if (appointments[i].time.hour == appointments[j].time.hour)
-                            {
-                                if (appointments[i].time.min > appointments[j].time.min)
-                                {
-                                    temp = appointments[i];
-                                    appointments[i] = appointments[j];
-                                    appointments[j] = temp;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+    return data->snapshot != NULL && (const char*)block >= data->snapshot &&
+           (const char*)block < data->snapshot + data->snapshotSize;
 }
 
-// Calculates number of days by using the month and year (accounts for leap year)
-void setDay (int *dayPTR, int year, int month)
+// Resizes a table or index block like realloc (a block in the loaded snapshot is copied instead,
+// oldSize bytes of it are kept)
+void* resizeData(const struct ClinicData* data, void* block, size_t oldSize, size_t newSize)
 {
-    int minDayBound = 1;
-    int maxDayBound = 0;
-    int dayEntered;
+    void* resized;
 
-    if (month == 2)
+    if (isSnapshotData(data, block))
     {
-        if ( ((year % 4 == 0) && (year % 100 != 0)) || year % 400 == 0)
-        {
-            maxDayBound = 29;
-        }
-        else
+        resized = malloc(newSize);
+
+        if (resized != NULL)
         {
-            maxDayBound = 28;
+            memcpy(resized, block, oldSize < newSize ? oldSize : newSize);
         }
     }
-    else if (month == 1 || month == 3 || month == 5 || month == 7 || month == 8 || month == 10 || month == 12)
-    {
-        maxDayBound = 31;
-    }
     else
     {
-        maxDayBound = 30;
+        resized = realloc(block, newSize);
     }
 
-    printf("Day (%d-%d)  : ", 1, maxDayBound);
-    dayEntered = inputIntRange(minDayBound, maxDayBound);
-
-    *dayPTR = dayEntered;
-
+    return resized;
 }
 
-// Finds the number of BOOKED appointments out of the max number of appointments
-int numberOfAppointments (struct Appointment *appointments, int maxAppointments, int *returnValue)
+// Releases a table or index block like free (a block in the loaded snapshot is left to the mapping)
+void releaseData(const struct ClinicData* data, void* block)
 {
-    int i;
-    int returnNumber = 0;
-
-    for (i = 0; i < maxAppointments; i++)
+    if (!isSnapshotData(data, block))
     {
-        if (appointments[i].date.year != 0000)
-        {
-            returnNumber++;
-        }
+        free(block);
     }
-
-    *returnValue = returnNumber;
-
-    return *returnValue;
 }
 
-// Finds an empty appointment in the appointment struct array, and returns the index
-int findEmptyAppointment (struct Appointment *appointments, int maxAppointments)
+// Grows the patient table geometrically to hold at least the number of slots (returns 1 on success)
+int reservePatients(struct ClinicData* data, int capacity)
 {
-    int i;
-    int index = -1;
-    int flag = 0;
+    int nextCapacity = data->patientCapacity;
+    int numberCapacity = data->patientCapacity;
+    int phoneCapacity = data->patientCapacity;
+    int contactCapacity = data->patientCapacity;
+    int reserved = capacity <= data->patientCapacity;
 
-    for (i = 0, flag = 0; i < maxAppointments && flag == 0; i++)
+    // The columns always share patientCapacity, it is only updated once all of them have grown
+    if (!reserved &&
+        growArray(data, (void**)&data->patientNumbers, &numberCapacity, capacity, sizeof(*data->patientNumbers)) &&
+        growArray(data, (void**)&data->patientPhones, &phoneCapacity, capacity, sizeof(*data->patientPhones)) &&
+        growArray(data, (void**)&data->patientContacts, &contactCapacity, capacity, sizeof(*data->patientContacts)))
     {
-        if (appointments[i].date.year == 0 && appointments[i].date.month == 0 && appointments[i].date.day == 0 && appointments[i].time.hour == 0 && appointments[i].time.min == 0)
+        reserved = growArray(data, (void**)&data->patientNames, &data->patientCapacity, capacity, sizeof(*data->patientNames));
+
+        // The phone index links grow with the table (dropped if that fails, phone searches then scan)
+        if (reserved && data->phoneNext != NULL &&
+            !growArray(data, (void**)&data->phoneNext, &nextCapacity, data->patientCapacity, sizeof(*data->phoneNext)))
         {
-            index = i;
-            flag = 1;
+            freePhoneIndex(data);
         }
     }
 
-    return index;
+    return reserved;
 }
 
-// Finds appointment based on the date and time, returns the index of the matched appointment
-int findAppointment (struct Appointment appointment[], int patientNumber, int year, int month, int day, int maxAppointments)
+// Grows the appointment table geometrically to hold at least the number of rows (returns 1 on success)
+int reserveAppointments(struct ClinicData* data, int capacity)
 {
-    int flag = 0;
-    int index = -1;
-    int i = 0;
+    int timeCapacity = data->appointmentCapacity;
+    int reserved = capacity <= data->appointmentCapacity;
 
-    do
+    // The columns always share appointmentCapacity, it is only updated once both have grown
+    if (!reserved &&
+        growArray(data, (void**)&data->appointmentTimes, &timeCapacity, capacity, sizeof(*data->appointmentTimes)))
     {
-        if (patientNumber == appointment[i].patientNum && year == appointment[i].date.year && month == appointment[i].date.month && day == appointment[i].date.day)
-        {
-            index = i;
-            flag = 1;
-        }
-
-        i++;
-
-    } while (flag == 0 && i <= maxAppointments);
+        reserved = growArray(data, (void**)&data->appointmentPatients, &data->appointmentCapacity, timeCapacity,
+                             sizeof(*data->appointmentPatients));
+    }
 
-    return index;
+    return reserved;
 }
 
-
-
-//////////////////////////////////////
-// USER INPUT FUNCTIONS
-//////////////////////////////////////
-
-// Get user input for a new patient record
-void inputPatient(struct Patient* patient)
+// Gets the full record of the appointment at the index
+void appointmentAt(const struct ClinicData* data, int index, struct Appointment* appoint)
 {
-    printf("Patient Data Input");
-    putchar('\n');
-    printf("------------------");
-    putchar('\n');
-    printf("Number: %05d", patient->patientNumber);
-    putchar('\n');
-    printf("Name  : ");
-    inputCString(patient->name, 1, 15, 0);
-    putchar('\n');
-    inputPhoneData(&patient->phone);
+    appoint->patientNum = data->appointmentPatients[index];
+    appointmentFromKey(data->appointmentTimes[index], appoint);
 }
 
-
-// Get user input for phone contact information
-void inputPhoneData(struct Phone* phone)
+// Gets the full record of the patient in the slot
+void patientAt(const struct ClinicData* data, int index, struct Patient* patient)
 {
-    int selection;
-
-    printf("Phone Information");
-    putchar('\n');
-    printf("-----------------");
-    putchar('\n');
-    printf("How will the patient like to be contacted?");
-    putchar('\n');
-    printf("1. Cell");
-    putchar('\n');
-    printf("2. Home");
-    putchar('\n');
-    printf("3. Work");
-    putchar('\n');
-    printf("4. TBD");
-    putchar('\n');
-    printf("Selection: ");
-    selection = inputIntRange(1,4);
-
-    switch (selection)
-    {
-        case 1:
-            strcpy(phone->description, "CELL");
-            putchar('\n');
-            printf("Contact: %s", phone->description);
-            putchar('\n');
-            printf("Number : ");
-            inputPhoneNumber(phone->number, PHONE_LEN);
-            break;
-        case 2:
-            strcpy(phone->description, "HOME");
-            putchar('\n');
-            printf("Contact: %s", phone->description);
-            putchar('\n');
-            printf("Number : ");
-            inputPhoneNumber(phone->number, PHONE_LEN);
-            break;
-        case 3:
-            strcpy(phone->description, "WORK");
-            putchar('\n');
-            printf("Contact: %s", phone->description);
-            putchar('\n');
-            printf("Number : ");
-            inputPhoneNumber(phone->number, PHONE_LEN);
-            break;
-        case 4:
-            strcpy(phone->description, "TBD");
-            *phone->number = '\0'; // Sets string to empty
-            break;
-        default:
-            break;
-    }
+    patient->patientNumber = data->patientNumbers[index];
+    strcpy(patient->name, patientName(data, index));
+    strcpy(patient->phone.description, contactNames[data->patientContacts[index]]);
+    unpackPhone(data->patientPhones[index], patient->phone.number);
 }
 
-// Used to input appointment information when adding an appointment, returns a number if setting the data was successful
-int inputAppointment (struct Appointment *appointment)
+// Gets the name of the patient in the slot (only valid until the next storePatient)
+const char* patientName(const struct ClinicData* data, int index)
 {
-    int flag = 0;
-
-    printf("Year        : ");
-    scanf("%d", &appointment->date.year);
-
-    printf("Month (1-12): ");
-    scanf("%d", &appointment->date.month);
+    return data->patientNumbers[index] != 0 ? data->nameArena + data->patientNames[index] : "";
+}
 
-    setDay(&appointment->date.day, appointment->date.year, appointment->date.month);
+// Stores the record in the patient slot, the phone must be one contactType and packPhone accept
+// (returns 1 on success, 0 if out of memory). Remove the slot's phone and name index entries
+// before and add them back after, see index.h.
+int storePatient(struct ClinicData* data, int index, const struct Patient* patient)
+{
+    int stored = storeName(data, index, patient->name);
 
-    do
+    if (stored)
     {
-        printf("Hour (0-23)  : ");
-        scanf("%d", &appointment->time.hour);
-
-        printf("Minute (0-59): ");
-        scanf("%d", &appointment->time.min);
-
-        flag = 0;
+        data->patientNumbers[index] = patient->patientNumber;
+        data->patientPhones[index] = patient->phone.number[0] != '\0' ? packPhone(patient->phone.number) : PHONE_NONE;
+        data->patientContacts[index] = (unsigned char)contactType(patient->phone.description);
 
-        if ((appointment->time.hour > END_HOUR || appointment->time.hour < START_HOUR) || (appointment->time.hour == END_HOUR && appointment->time.min == MINUTE_INTERVAL) || (appointment->time.min != 0 && appointment->time.min != MINUTE_INTERVAL) )
+        // Imports and journal replays go through here too, so the high-water mark is always current
+        if (patient->patientNumber > data->lastPatientNumber)
         {
-            printf("ERROR: Time must be between %d:00 and %d:00 in %d minute intervals.\n\n", START_HOUR, END_HOUR, MINUTE_INTERVAL);
+            data->lastPatientNumber = patient->patientNumber;
         }
-        else
-        {
-            flag = 1;
-        }
-
-    } while (flag == 0);
-
-    return flag;
+    }
 
+    return stored;
 }
 
-
-
-//////////////////////////////////////
-// FILE FUNCTIONS
-//////////////////////////////////////
-
-// Import patient data from file into a Patient array (returns # of records read)
-int importPatients(const char* datafile, struct Patient patients[], int max)
+// Gets an empty patient slot after the last patient (returns the index, -1 if out of memory)
+int allocatePatient(struct ClinicData* data)
 {
-    int i = 0;
-
-    FILE *fp = NULL;
-
-    fp = fopen(datafile, "r");
-
-    i = 0;
+    int index = -1;
 
-    if (fp != NULL)
+    if (reservePatients(data, data->maxPatient + 1))
     {
-        while (i < max && !feof(fp))
-        {
-            fscanf(fp, "%d|%14[^|]|%4[^|]|%10[^\n]", &patients[i].patientNumber, patients[i].name, patients[i].phone.description, patients[i].phone.number);
-            i++;
-        };
+        index = data->maxPatient;
+        data->maxPatient++;
 
-        fclose(fp);
-        fp = NULL;
-    }
-    else
-    {
-        printf("Error opening file, please try again!\n");
+        // Starts empty, it may still hold a patient releasePatient moved out of it
+        data->patientNumbers[index] = 0;
+        data->patientPhones[index] = PHONE_NONE;
     }
 
-    return i;
+    return index;
 }
 
-// Import appointment data from file into an Appointment array (returns # of records read)
-int importAppointments(const char* datafile, struct Appointment appoints[], int max)
+// Clears a patient slot (already removed from the indexes) and moves the last patient into it
+void releasePatient(struct ClinicData* data, int index)
 {
-    int i = 0;
-    FILE *fp = NULL;
-
-    fp = fopen(datafile, "r");
+    int last = data->maxPatient - 1;
 
-    i = 0;
-
-    if (fp != NULL)
+    // The name stays in the arena until it is compacted
+    if (data->patientNumbers[index] != 0)
     {
-        while (i < max && !feof(fp))
-        {
-            fscanf(fp, "%d,%d,%d,%d,%d,%d", &appoints[i].patientNum, &appoints[i].date.year, &appoints[i].date.month, &appoints[i].date.day, &appoints[i].time.hour, &appoints[i].time.min);
-            i++;
-        }
-
-        fclose(fp);
-        fp = NULL;
+        data->nameArenaFree += (int)strlen(patientName(data, index)) + 1;
     }
-    else
+
+    // Slots 0 to maxPatient - 1 always hold patients, so scans never meet a removed one
+    if (index != last)
     {
-        printf("Error opening file, please try again!\n");
-    }
+        unindexPatient(data, last);
 
-    sortAppointments(appoints, max);
+        data->patientNumbers[index] = data->patientNumbers[last];
+        data->patientPhones[index] = data->patientPhones[last];
+        data->patientContacts[index] = data->patientContacts[last];
+        data->patientNames[index] = data->patientNames[last];
 
-    return i;
-}
\ No newline at end of file
+        indexPatient(data, index);
+    }
+
+    data->maxPatient--;
+}
@@ -1,6 +1,8 @@
 #ifndef CLINIC_H
 #define CLINIC_H
 
+#include <stddef.h>
+
 
 //////////////////////////////////////
 // Module macro's (usable by any file that includes this header)
@@ -23,6 +25,20 @@
 #define END_HOUR 14
 #define MINUTE_INTERVAL 30
 
+// Bookable timeslots per day (START_HOUR:00 to END_HOUR:00 inclusive)
+#define SLOTS_PER_DAY (((END_HOUR - START_HOUR) * 60 / MINUTE_INTERVAL) + 1)
+
+// Minutes in a day (appointment keys count minutes)
+#define MINUTES_PER_DAY 1440
+
+// Appointments can be booked from the start of APPOINTMENT_FIRST_YEAR to the end of APPOINTMENT_LAST_YEAR,
+// appointment keys count the minutes from the first year (the range fits an unsigned 32-bit key)
+#define APPOINTMENT_FIRST_YEAR 1900
+#define APPOINTMENT_LAST_YEAR 9999
+
+// Packed phone number of a patient without one (see packPhone)
+#define PHONE_NONE -1
+
 
 //////////////////////////////////////
 // Structures
@@ -41,6 +57,15 @@ struct Patient
     struct Phone phone;
 };
 
+// How a patient would like to be contacted (the phone descriptions, stored in one byte)
+enum ContactType
+{
+    CONTACT_CELL,
+    CONTACT_HOME,
+    CONTACT_WORK,
+    CONTACT_TBD
+};
+
 struct Time
 {
     int hour;
@@ -64,140 +89,248 @@ struct Appointment
     struct Date date;
 };
 
-
-// !!! DO NOT MODIFY THIS DATA TYPE !!!
-struct ClinicData
+// Patients sharing one phone number (first = lowest patients[] index, the rest are chained)
+struct PhoneSlot
 {
-    struct Patient* patients;
-    int maxPatient;
-    struct Appointment* appointments;
-    int maxAppointments;
+    long long phone;
+    int first;
 };
 
+// Patients whose name contains one trigram (in no particular order)
+struct NamePostings
+{
+    int* slots;
+    int count;
+    int capacity;
+};
 
+// Timeslot occupancy of one day (bit n set = slot n is booked)
+struct DaySlots
+{
+    long day;
+    unsigned int taken;
+};
 
-//////////////////////////////////////
-// DISPLAY FUNCTIONS
-//////////////////////////////////////
 
-// Display's the patient table header (table format)
-void displayPatientTableHeader(void);
+// Outcome of a clinic operation (see the CLINIC OPERATIONS)
+enum ClinicResult
+{
+    CLINIC_OK,
+    CLINIC_BAD_PATIENT,             // unknown phone description or not a 10 digit number
+    CLINIC_BAD_APPOINTMENT,         // date not on the calendar (or outside the bookable years)
+    CLINIC_NOT_FOUND,               // no patient with that number
+    CLINIC_NO_APPOINTMENT,          // no appointment at that date (and time)
+    CLINIC_BAD_TIME,                // not a timeslot from START_HOUR to END_HOUR
+    CLINIC_SLOT_TAKEN,              // timeslot already booked
+    CLINIC_FULL                     // out of memory
+};
 
-// Displays a single patient record in FMT_FORM | FMT_TABLE format
-void displayPatientData(const struct Patient* patient, int fmt);
+// Journal of the changes since the last save (see journal.h)
+struct Journal;
 
-// Display's appointment schedule headers (date-specific or all records)
-void displayScheduleTableHeader(const struct Date* date, int isAllRecords);
+// Patient and appointment tables, plus the indexes kept in sync with them (see index.h)
+// Both tables grow on demand (see the DATA FUNCTIONS), so the max* members count the
+// rows in use rather than a fixed array size.
+struct ClinicData
+{
+    int maxPatient;                 // patients, always stored in slots 0 to maxPatient - 1
+    int maxAppointments;            // booked appointments
+
+    // Patient table, stored as columns (see patientAt for the full record). The number and
+    // packed phone are what the scans and indexes read, the rest is only read for display.
+    int* patientNumbers;            // 0 = slot not stored yet (see allocatePatient)
+    long long* patientPhones;       // packPhone() of the number, PHONE_NONE if there is none
+    unsigned char* patientContacts; // enum ContactType
+    int* patientNames;              // offset of the name in nameArena
+
+    // Patient names, one after the other with their '\0'. Replaced names are left in place
+    // and counted in nameArenaFree until the arena is compacted.
+    char* nameArena;
+    int nameArenaUsed;
+    int nameArenaCapacity;
+    int nameArenaFree;
+
+    // Appointment table, stored as columns sorted by time (see appointmentAt for the full record):
+    // the patient number and the packed appointmentKey() of each appointment. The time column
+    // is also the calendar index, date ranges are binary searched and scanned in it directly.
+    int* appointmentPatients;
+    unsigned int* appointmentTimes;
+
+    // Allocated rows of each table
+    int patientCapacity;
+    int appointmentCapacity;
+
+    // Highest patient number stored since the data was loaded (or kept in the snapshot), new patients are numbered after it
+    int lastPatientNumber;
+
+    // Open-addressing hash table: patient number -> patients[] index (-1 = empty)
+    int* patientTable;
+    int patientTableSize;
+    int patientTableUsed;
+
+    // Open-addressing hash table: packed phone number -> patients with it, each patient
+    // slot links to the next one with the same phone in phoneNext (-1 = last)
+    struct PhoneSlot* phoneTable;
+    int phoneTableSize;
+    int phoneTableUsed;
+    int* phoneNext;
+
+    // Trigram index: NAME_TRIGRAMS posting lists of the patients[] indexes whose name has the trigram
+    struct NamePostings* nameIndex;
+
+    // Open-addressing hash table: day number -> timeslot occupancy bitmap
+    struct DaySlots* daySlots;
+    int daySlotsSize;
+    int daySlotsUsed;
+
+    // Data files the tables are saved to (NULL until they are loaded)
+    const char* patientFile;
+    const char* appointmentFile;
+
+    // Changes are appended here as they are made (NULL = only saved on exit or by compactJournal)
+    struct Journal* journal;
+
+    // Mapped snapshot the tables and indexes were loaded from (see snapshot.h, NULL = all on the heap).
+    // Blocks inside it are changed in place and only copied to the heap when they have to grow.
+    char* snapshot;
+    size_t snapshotSize;
+};
 
-// Display a single appointment record with patient info. in tabular format
-void displayScheduleData(const struct Patient* patient,
-                         const struct Appointment* appoint,
-                         int includeDateField);
 
 
 //////////////////////////////////////
-// MENU & ITEM SELECTION FUNCTIONS
+// UTILITY FUNCTIONS
 //////////////////////////////////////
 
-// Menu: Main
-void menuMain(struct ClinicData* data);
+// Get the next highest patient number (removed numbers are not given out again while the data is loaded,
+// but the data files only keep the live patients, so after a restart the numbering goes on from the highest one)
+int nextPatientNumber(const struct ClinicData* data);
 
-// Menu: Patient Management
-void menuPatient(struct Patient patient[], int max);
+// Gets the contact type of a phone description (returns -1 if it isn't CELL, HOME, WORK or TBD)
+int contactType(const char* description);
 
-// Menu: Patient edit
-void menuPatientEdit(struct Patient* patient);
+// Find the patient array index by patient number (returns -1 if not found)
+int findPatientIndexByPatientNum(int patientNumber, const struct ClinicData* data);
 
-// Menu: Appointment Management
-void menuAppointment(struct ClinicData* data);
+// Calculates the number of days from 0000-03-01 to the given date
+long dayNumber (int year, int month, int day);
 
-// Display's all patient data in the FMT_FORM | FMT_TABLE format
-void displayAllPatients(const struct Patient patient[], int max, int fmt);
+// Converts a day number (from dayNumber) back to a calendar date
+void dateFromDayNumber (long dayNum, struct Date *date);
 
-// Search for a patient record based on patient number or phone number
-void searchPatientData(const struct Patient patient[], int max);
+// Packs an appointment's date and time into one 32-bit key (minutes since APPOINTMENT_FIRST_YEAR began)
+unsigned int appointmentKey (const struct Appointment *appoint);
 
-// Add a new patient record to the patient array
-void addPatient(struct Patient patient[], int max);
+// Gets the day number (see dayNumber) of a packed appointment key
+long appointmentKeyDay (unsigned int key);
 
-// Edit a patient record from the patient array
-void editPatient(struct Patient patient[], int max);
+// Unpacks an appointment key back into the appointment's date and time
+void appointmentFromKey (unsigned int key, struct Appointment *appoint);
 
-// Remove a patient record from the patient array
-void removePatient(struct Patient patient[], int max);
+// Radix sorts the appointment columns by their packed key (used after an import).
+// insertAppointment and deleteAppointment keep the columns in this order, so views never re-sort.
+void sortAppointments (int *patients, unsigned int *times, int max);
 
-// View ALL scheduled appointments
-void viewAllAppointments (struct ClinicData *data);
+// Inserts an appointment at its sorted position, returns the index (-1 if out of memory)
+int insertAppointment (struct ClinicData *data, const struct Appointment *appoint);
 
-// View appointment schedule for the user input date
-void viewAppointmentSchedule (struct ClinicData *data);
+// Removes the appointment at the index, shifting later appointments down to keep the order
+void deleteAppointment (struct ClinicData *data, int index);
 
-// Add an appointment record to the appointment array
-void addAppointment (struct Appointment *appointments, int maxAppointments, struct Patient *patients, int maxPatient);
+// Finds the patient's appointment among count appointments starting at first, returns its index (-1 if none)
+int findAppointment (const struct ClinicData *data, int patientNumber, int first, int count);
 
-// Remove an appointment record from the appointment array
-void removeAppointment (struct Appointment *appointments, int maxAppointments, struct Patient *patients, int maxPatient);
+// Gets the number of days in the month (accounts for leap year)
+int daysInMonth (int year, int month);
 
 
 
 //////////////////////////////////////
-// UTILITY FUNCTIONS
+// CLINIC OPERATIONS
 //////////////////////////////////////
 
-// Search and display patient record by patient number (form)
-void searchPatientByPatientNumber(const struct Patient patient[], int max);
+// These check, change, index and journal the clinic data without any user input or output, for the
+// menus (see menu.h), the batch commands and anything else linking the clinic library
 
-// Search and display patient records by phone number (tabular)
-void searchPatientByPhoneNumber(const struct Patient patient[], int max);
+// Gets the text of a result, as the batch commands report it
+const char* clinicResultMessage(enum ClinicResult result);
 
-// Get the next highest patient number
-int nextPatientNumber(const struct Patient patient[], int max);
+// Gets the patient by number (returns CLINIC_OK or CLINIC_NOT_FOUND)
+enum ClinicResult clinicFindPatient(const struct ClinicData* data, int patientNumber, struct Patient* patient);
 
-// Find the patient array index by patient number (returns -1 if not found)
-int findPatientIndexByPatientNum(int patientNumber,
-                                 const struct Patient patient[], int max);
+// Adds the patient under the next patient number, which is set in the record
+// (returns CLINIC_OK, CLINIC_BAD_PATIENT or CLINIC_FULL)
+enum ClinicResult clinicAddPatient(struct ClinicData* data, struct Patient* patient);
 
-// Bubble sorts appointments by year, month, day, hour, and minute
-void sortAppointments (struct Appointment *appointments, int max);
+// Replaces the name and phone of the patient with the record's number
+// (returns CLINIC_OK, CLINIC_BAD_PATIENT, CLINIC_NOT_FOUND or CLINIC_FULL)
+enum ClinicResult clinicEditPatient(struct ClinicData* data, const struct Patient* patient);
 
-// Finds appointment based on the date and time, returns the index of the matched appointment
-int findAppointment (struct Appointment appointment[], int patientNumber, int year, int month, int day, int maxAppointments);
+// Removes the patient by number, removed gets the record (returns CLINIC_OK or CLINIC_NOT_FOUND)
+enum ClinicResult clinicRemovePatient(struct ClinicData* data, int patientNumber, struct Patient* removed);
 
-// Finds an empty appointment in the appointment struct array, and returns the index
-int findEmptyAppointment (struct Appointment *appointments, int maxAppointments);
+// Books the appointment, suggested gets the next free timeslot when it is taken (may be NULL)
+// (returns CLINIC_OK, CLINIC_BAD_APPOINTMENT, CLINIC_NOT_FOUND, CLINIC_BAD_TIME, CLINIC_SLOT_TAKEN or CLINIC_FULL)
+enum ClinicResult clinicAddAppointment(struct ClinicData* data, const struct Appointment* appoint,
+                                       struct Appointment* suggested);
 
-// Finds the number of BOOKED appointments out of the max number of appointments
-int numberOfAppointments (struct Appointment *appointments, int maxAppointments, int *returnValue);
+// Gets the patient's appointment on the date (returns CLINIC_OK, CLINIC_NOT_FOUND or CLINIC_NO_APPOINTMENT)
+enum ClinicResult clinicFindAppointment(const struct ClinicData* data, int patientNumber, const struct Date* date,
+                                        struct Appointment* appoint);
 
-// Calculates number of days by using the month and year (accounts for leap year)
-void setDay (int *dayPTR, int year, int month);
+// Cancels the appointment booked at exactly its date and time (returns CLINIC_OK or CLINIC_NO_APPOINTMENT)
+enum ClinicResult clinicRemoveAppointment(struct ClinicData* data, const struct Appointment* appoint);
+
+// Gets the appointments from one date to another, inclusive (both NULL = all of them): the index of the
+// first one and how many there are, in time order (returns CLINIC_OK or CLINIC_BAD_APPOINTMENT)
+enum ClinicResult clinicSchedule(const struct ClinicData* data, const struct Date* from, const struct Date* to,
+                                 int* first, int* count);
 
 
 
 //////////////////////////////////////
-// USER INPUT FUNCTIONS
+// DATA FUNCTIONS
 //////////////////////////////////////
 
-// Get user input for a new patient record
-void inputPatient(struct Patient* patient);
+// Sets up empty patient/appointment tables with room for the given number of rows (returns 1 on success)
+int initClinicData(struct ClinicData* data, int patientCapacity, int appointmentCapacity);
 
-// Get user input for phone contact information
-void inputPhoneData(struct Phone* phone);
+// Releases the tables and every index owned by the ClinicData
+void freeClinicData(struct ClinicData* data);
 
-// Used to input appointment information when adding an appointment, returns a number if setting the data was successful
-int inputAppointment (struct Appointment *appointment);
+// Resizes a table or index block like realloc (a block in the loaded snapshot is copied instead,
+// oldSize bytes of it are kept)
+void* resizeData(const struct ClinicData* data, void* block, size_t oldSize, size_t newSize);
 
+// Releases a table or index block like free (a block in the loaded snapshot is left to the mapping)
+void releaseData(const struct ClinicData* data, void* block);
 
+// Grows the patient table geometrically to hold at least the number of slots (returns 1 on success)
+int reservePatients(struct ClinicData* data, int capacity);
 
-//////////////////////////////////////
-// FILE FUNCTIONS
-//////////////////////////////////////
+// Grows the appointment table geometrically to hold at least the number of rows (returns 1 on success)
+int reserveAppointments(struct ClinicData* data, int capacity);
+
+// Gets the full record of the appointment at the index
+void appointmentAt(const struct ClinicData* data, int index, struct Appointment* appoint);
+
+// Gets the full record of the patient in the slot
+void patientAt(const struct ClinicData* data, int index, struct Patient* patient);
+
+// Gets the name of the patient in the slot (only valid until the next storePatient)
+const char* patientName(const struct ClinicData* data, int index);
+
+// Stores the record in the patient slot, the phone must be one contactType and packPhone accept
+// (returns 1 on success, 0 if out of memory). Remove the slot's phone and name index entries
+// before and add them back after, see index.h.
+int storePatient(struct ClinicData* data, int index, const struct Patient* patient);
+
+// Gets an empty patient slot after the last patient (returns the index, -1 if out of memory)
+int allocatePatient(struct ClinicData* data);
 
-// Import patient data from file into a Patient array (returns # of records read)
-int importPatients(const char* datafile, struct Patient patients[], int max);
+// Clears a patient slot (already removed from the indexes) and moves the last patient into it
+void releasePatient(struct ClinicData* data, int index);
 
-// Import appointment data from file into an Appointment array (returns # of records read)
-int importAppointments(const char* datafile, struct Appointment appoints[], int max);
 
 
 #endif // !CLINIC_H
\ No newline at end of file
@@ -0,0 +1,628 @@
+/*
+*****************************************************************************
+The following functions run the clinic without menus: one command per line,
+   answered with "OK <n>" followed by n records in the data file formats,
+                  or with a single "ERR <message>" line.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "command.h"
+#include "fileio.h"
+#include "index.h"
+#include "journal.h"
+#include "stats.h"
+
+
+// A command's name, the function running it (given the text after the name) and if it changes the data
+struct Command
+{
+    const char* name;
+    int (*run)(struct ClinicData* data, const char* args, FILE* out);
+    int writes;
+};
+
+// Progress of a batch run, shared with the line handler
+struct BatchState
+{
+    struct ClinicData* data;
+    FILE* out;
+    int failed;
+};
+
+
+// Writes an error answer (always returns 0, the command failed)
+static int fail(FILE* out, const char* message)
+{
+    fprintf(out, "ERR %s\n", message);
+
+    return 0;
+}
+
+// Writes a patient as a patientData.txt line
+static void writePatient(FILE* out, const struct Patient* patient)
+{
+    char line[EXPORT_LINE_MAX];
+
+    fwrite(line, 1, formatPatientLine(patient, line), out);
+}
+
+// Writes the patient in the slot as a patientData.txt line
+static void writeStoredPatient(FILE* out, const struct ClinicData* data, int index)
+{
+    struct Patient patient;
+
+    patientAt(data, index, &patient);
+    writePatient(out, &patient);
+}
+
+// Writes an appointment as an appointmentData.txt line
+static void writeAppointment(FILE* out, const struct Appointment* appoint)
+{
+    char line[EXPORT_LINE_MAX];
+
+    fwrite(line, 1, formatAppointmentLine(appoint, line), out);
+}
+
+// Reads a whole argument as a positive number (returns 1 if it is one)
+static int parseNumber(const char* text, int* value)
+{
+    char* end;
+    long number = strtol(text, &end, 10);
+
+    *value = (int)number;
+
+    return end != text && *end == '\0' && number > 0 && number <= 2147483647L;
+}
+
+// Reads a "YYYY-MM-DD" date, sets the rest to after it (returns 1 if it has that form, clinicSchedule checks the date)
+static int parseDate(const char* text, struct Date* date, const char** rest)
+{
+    int length = 0;
+    int valid = sscanf(text, "%4d-%2d-%2d%n", &date->year, &date->month, &date->day, &length) == 3;
+
+    if (valid)
+    {
+        *rest = text + length;
+    }
+
+    return valid;
+}
+
+// Parses a patient record argument (returns 1 if it is well formed, the clinic operations check the phone)
+static int parsePatientArgs(const char* args, struct Patient* patient)
+{
+    return parsePatientLine(args, args + strlen(args), patient);
+}
+
+// add-patient name|description|phone
+static int runAddPatient(struct ClinicData* data, const char* args, FILE* out)
+{
+    char line[COMMAND_LINE_MAX + 16];
+    struct Patient patient;
+    enum ClinicResult result;
+    int done = 0;
+
+    // The patient number is given out by clinicAddPatient, the record is parsed with a placeholder
+    snprintf(line, sizeof(line), "1|%s", args);
+
+    if (!parsePatientArgs(line, &patient))
+    {
+        fail(out, "Malformed patient record");
+    }
+    else if ((result = clinicAddPatient(data, &patient)) != CLINIC_OK)
+    {
+        fail(out, clinicResultMessage(result));
+    }
+    else
+    {
+        fprintf(out, "OK 1\n");
+        writePatient(out, &patient);
+        done = 1;
+    }
+
+    return done;
+}
+
+// edit-patient number|name|description|phone (replaces the name and phone)
+static int runEditPatient(struct ClinicData* data, const char* args, FILE* out)
+{
+    struct Patient patient;
+    enum ClinicResult result;
+    int done = 0;
+
+    if (!parsePatientArgs(args, &patient))
+    {
+        fail(out, "Malformed patient record");
+    }
+    else if ((result = clinicEditPatient(data, &patient)) != CLINIC_OK)
+    {
+        fail(out, clinicResultMessage(result));
+    }
+    else
+    {
+        fprintf(out, "OK 1\n");
+        writePatient(out, &patient);
+        done = 1;
+    }
+
+    return done;
+}
+
+// remove-patient number
+static int runRemovePatient(struct ClinicData* data, const char* args, FILE* out)
+{
+    struct Patient removed;
+    int patientNumber;
+    int done = 0;
+
+    if (!parseNumber(args, &patientNumber))
+    {
+        fail(out, "Malformed patient number");
+    }
+    else if (clinicRemovePatient(data, patientNumber, &removed) != CLINIC_OK)
+    {
+        fail(out, "Patient record not found");
+    }
+    else
+    {
+        fprintf(out, "OK 1\n");
+        writePatient(out, &removed);
+        done = 1;
+    }
+
+    return done;
+}
+
+// get-patient number
+static int runGetPatient(struct ClinicData* data, const char* args, FILE* out)
+{
+    struct Patient patient;
+    int patientNumber;
+    int done = 0;
+
+    if (!parseNumber(args, &patientNumber))
+    {
+        fail(out, "Malformed patient number");
+    }
+    else if (clinicFindPatient(data, patientNumber, &patient) != CLINIC_OK)
+    {
+        fail(out, "Patient record not found");
+    }
+    else
+    {
+        fprintf(out, "OK 1\n");
+        writePatient(out, &patient);
+        done = 1;
+    }
+
+    return done;
+}
+
+// find-phone phone (every patient with the number, in table order)
+static int runFindPhone(struct ClinicData* data, const char* args, FILE* out)
+{
+    long long phone = packPhone(args);
+    int count = 0;
+    int first;
+    int i;
+
+    if (phone == -1)
+    {
+        fail(out, "Malformed phone number");
+    }
+    else if (data->phoneTable != NULL)
+    {
+        // Looked up once, the chain is walked twice (to count, then to write)
+        first = lookupPhone(data, phone);
+
+        for (i = first; i != -1; i = nextPhonePatient(data, i))
+        {
+            count++;
+        }
+
+        fprintf(out, "OK %d\n", count);
+
+        for (i = first; i != -1; i = nextPhonePatient(data, i))
+        {
+            writeStoredPatient(out, data, i);
+        }
+    }
+    else
+    {
+        for (i = 0; i < data->maxPatient; i++)
+        {
+            count += data->patientPhones[i] == phone;
+        }
+
+        fprintf(out, "OK %d\n", count);
+
+        for (i = 0; i < data->maxPatient; i++)
+        {
+            if (data->patientPhones[i] == phone)
+            {
+                writeStoredPatient(out, data, i);
+            }
+        }
+    }
+
+    return phone != -1;
+}
+
+// find-name letters (best matches first)
+static int runFindName(struct ClinicData* data, const char* args, FILE* out)
+{
+    int matches[NAME_MATCHES_MAX];
+    int valid = args[0] != '\0' && strlen(args) < NAME_LEN;
+    int count;
+    int i;
+
+    if (!valid)
+    {
+        fail(out, "Malformed name");
+    }
+    else
+    {
+        count = searchPatientName(data, args, matches, NAME_MATCHES_MAX);
+
+        fprintf(out, "OK %d\n", count);
+
+        for (i = 0; i < count; i++)
+        {
+            writeStoredPatient(out, data, matches[i]);
+        }
+    }
+
+    return valid;
+}
+
+// list-patients
+static int runListPatients(struct ClinicData* data, const char* args, FILE* out)
+{
+    int valid = args[0] == '\0';
+    int i;
+
+    if (!valid)
+    {
+        fail(out, "list-patients takes no arguments");
+    }
+    else
+    {
+        fprintf(out, "OK %d\n", data->maxPatient);
+
+        for (i = 0; i < data->maxPatient; i++)
+        {
+            writeStoredPatient(out, data, i);
+        }
+    }
+
+    return valid;
+}
+
+// add-appointment patient,year,month,day,hour,minute
+static int runAddAppointment(struct ClinicData* data, const char* args, FILE* out)
+{
+    char message[80];
+    struct Appointment appoint;
+    struct Appointment suggested;
+    enum ClinicResult result = CLINIC_BAD_APPOINTMENT;
+
+    if (parseAppointmentLine(args, args + strlen(args), &appoint))
+    {
+        result = clinicAddAppointment(data, &appoint, &suggested);
+    }
+
+    if (result == CLINIC_BAD_TIME)
+    {
+        sprintf(message, "Time must be between %d:00 and %d:00 in %d minute intervals",
+                START_HOUR, END_HOUR, MINUTE_INTERVAL);
+        fail(out, message);
+    }
+    else if (result == CLINIC_SLOT_TAKEN)
+    {
+        sprintf(message, "Appointment timeslot is not available, next available %d,%d,%d,%d,%d",
+                suggested.date.year, suggested.date.month, suggested.date.day, suggested.time.hour, suggested.time.min);
+        fail(out, message);
+    }
+    else if (result != CLINIC_OK)
+    {
+        fail(out, clinicResultMessage(result));
+    }
+    else
+    {
+        fprintf(out, "OK 1\n");
+        writeAppointment(out, &appoint);
+    }
+
+    return result == CLINIC_OK;
+}
+
+// remove-appointment patient,year,month,day,hour,minute
+static int runRemoveAppointment(struct ClinicData* data, const char* args, FILE* out)
+{
+    struct Appointment appoint;
+    enum ClinicResult result;
+    int done = 0;
+
+    if (!parseAppointmentLine(args, args + strlen(args), &appoint))
+    {
+        fail(out, "Malformed appointment record");
+    }
+    else if ((result = clinicRemoveAppointment(data, &appoint)) != CLINIC_OK)
+    {
+        fail(out, clinicResultMessage(result));
+    }
+    else
+    {
+        fprintf(out, "OK 1\n");
+        writeAppointment(out, &appoint);
+        done = 1;
+    }
+
+    return done;
+}
+
+// list-appointments [YYYY-MM-DD [YYYY-MM-DD]]
+static int runListAppointments(struct ClinicData* data, const char* args, FILE* out)
+{
+    struct Appointment appoint;
+    struct Date from;
+    struct Date to;
+    const char* rest = args;
+    int first = 0;
+    int count = 0;
+    int valid = 1;
+    int i;
+
+    if (args[0] != '\0')
+    {
+        valid = parseDate(args, &from, &rest);
+        to = from;
+
+        if (valid && rest[0] == ' ')
+        {
+            valid = parseDate(rest + 1, &to, &rest);
+        }
+
+        valid = valid && rest[0] == '\0' && clinicSchedule(data, &from, &to, &first, &count) == CLINIC_OK;
+    }
+    else
+    {
+        clinicSchedule(data, NULL, NULL, &first, &count);
+    }
+
+    if (!valid)
+    {
+        fail(out, "Malformed date range");
+    }
+    else
+    {
+        fprintf(out, "OK %d\n", count);
+
+        for (i = first; i < first + count; i++)
+        {
+            appointmentAt(data, i, &appoint);
+            writeAppointment(out, &appoint);
+        }
+    }
+
+    return valid;
+}
+
+// save
+static int runSave(struct ClinicData* data, const char* args, FILE* out)
+{
+    int done = 0;
+
+    if (args[0] != '\0')
+    {
+        fail(out, "save takes no arguments");
+    }
+    else if (!compactJournal(data))
+    {
+        fail(out, "Unable to save the clinic data files");
+    }
+    else
+    {
+        fprintf(out, "OK 0\n");
+        done = 1;
+    }
+
+    return done;
+}
+
+// stats [on|off|reset] (one "name|count|total|min|max|p50|p90|p99|p99.9" line per operation, in nanoseconds)
+static int runStats(struct ClinicData* data, const char* args, FILE* out)
+{
+    struct StatSummary summary;
+    int valid = 1;
+    int kind;
+
+    if (strcmp(args, "on") == 0 || strcmp(args, "off") == 0)
+    {
+        setStatsEnabled(args[1] == 'n');
+    }
+    else if (strcmp(args, "reset") == 0)
+    {
+        resetStats();
+    }
+    else if (args[0] != '\0')
+    {
+        valid = fail(out, "stats takes on, off or reset");
+    }
+
+    if (valid)
+    {
+        fprintf(out, "OK %d\n", STAT_KINDS);
+
+        for (kind = 0; kind < STAT_KINDS; kind++)
+        {
+            readStat(kind, &summary);
+            fprintf(out, "%s|%llu|%llu|%llu|%llu|%llu|%llu|%llu|%llu\n", summary.name, summary.count, summary.total,
+                    summary.min, summary.max, summary.p50, summary.p90, summary.p99, summary.p999);
+        }
+    }
+
+    return valid;
+}
+
+// Every command, looked up by name
+static const struct Command commands[] =
+{
+    { "add-patient", runAddPatient, 1 },
+    { "edit-patient", runEditPatient, 1 },
+    { "remove-patient", runRemovePatient, 1 },
+    { "get-patient", runGetPatient, 0 },
+    { "find-phone", runFindPhone, 0 },
+    { "find-name", runFindName, 0 },
+    { "list-patients", runListPatients, 0 },
+    { "add-appointment", runAddAppointment, 1 },
+    { "remove-appointment", runRemoveAppointment, 1 },
+    { "list-appointments", runListAppointments, 0 },
+    { "save", runSave, 1 },
+    { "stats", runStats, 0 }
+};
+
+// Finds the command a line starts with (returns NULL if there is no such command)
+static const struct Command* findCommand(const char* command)
+{
+    size_t length = strcspn(command, " ");
+    const struct Command* found = NULL;
+    int i;
+
+    for (i = 0; found == NULL && i < (int)(sizeof(commands) / sizeof(commands[0])); i++)
+    {
+        if (strlen(commands[i].name) == length && strncmp(commands[i].name, command, length) == 0)
+        {
+            found = &commands[i];
+        }
+    }
+
+    return found;
+}
+
+// Runs a batch file line as a command
+static int batchLine(const char* line, const char* end, long lineNumber, void* context)
+{
+    struct BatchState* state = context;
+    char command[COMMAND_LINE_MAX + 1];
+    int length = (int)(end - line);
+
+    (void)lineNumber;
+
+    if (length > 0 && line[length - 1] == '\r')
+    {
+        length--;
+    }
+
+    if (length > COMMAND_LINE_MAX)
+    {
+        state->failed += !fail(state->out, "Command line too long");
+    }
+    else
+    {
+        memcpy(command, line, length);
+        command[length] = '\0';
+
+        state->failed += !executeCommand(state->data, command, state->out);
+    }
+
+    return 1;
+}
+
+// Runs the commands of a pipe or terminal line by line, each answer is flushed before the next line is read
+// (returns 1 unless reading failed)
+static int batchStream(FILE* in, struct BatchState* state)
+{
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    long lineNumber = 0;
+
+    while ((length = getline(&line, &capacity, in)) != -1)
+    {
+        lineNumber++;
+        batchLine(line, line + length - (line[length - 1] == '\n'), lineNumber, state);
+        fflush(state->out);
+    }
+
+    free(line);
+
+    return !ferror(in);
+}
+
+
+//////////////////////////////////////
+// COMMAND FUNCTIONS
+//////////////////////////////////////
+
+// Runs one command (without the newline) and writes its answer (returns 1 if it succeeded)
+int executeCommand(struct ClinicData* data, const char* command, FILE* out)
+{
+    const struct Command* found;
+    size_t length = strcspn(command, " ");
+    int done = 1;
+
+    if (command[0] != '\0' && command[0] != '#')
+    {
+        found = findCommand(command);
+
+        if (found != NULL)
+        {
+            done = found->run(data, command[length] == ' ' ? command + length + 1 : command + length, out);
+        }
+        else
+        {
+            done = fail(out, "Unknown command");
+        }
+    }
+
+    return done;
+}
+
+// Checks if the command can change the data (returns 1 if it needs exclusive access)
+// Every other command only reads, so any number of them may run at the same time
+int commandWrites(const char* command)
+{
+    const struct Command* found = findCommand(command);
+
+    return found != NULL && found->writes;
+}
+
+// Runs every command of the file ("-" reads stdin), returns # of failed commands (-1 if it can't be read)
+// A regular file is read in large blocks, anything else (a pipe, a terminal) a line at a time
+int runBatch(struct ClinicData* data, const char* commandFile, FILE* out)
+{
+    struct BatchState state = { data, out, 0 };
+    struct stat info;
+    int fromStdin = strcmp(commandFile, "-") == 0;
+    int regular = fromStdin ? fstat(STDIN_FILENO, &info) == 0 && S_ISREG(info.st_mode)
+                            : stat(commandFile, &info) == 0 && S_ISREG(info.st_mode);
+    FILE* in = NULL;
+
+    if (regular)
+    {
+        state.failed = readLines(fromStdin ? "/dev/stdin" : commandFile, batchLine, &state) ? state.failed : -1;
+    }
+    else
+    {
+        in = fromStdin ? stdin : fopen(commandFile, "r");
+        state.failed = in != NULL && batchStream(in, &state) ? state.failed : -1;
+
+        if (in != NULL && in != stdin)
+        {
+            fclose(in);
+        }
+    }
+
+    fflush(out);
+
+    return state.failed;
+}
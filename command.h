@@ -0,0 +1,47 @@
+/*
+*****************************************************************************
+The following functions run the clinic without menus: one command per line,
+   answered with "OK <n>" followed by n records in the data file formats,
+                  or with a single "ERR <message>" line.
+*****************************************************************************
+*/
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdio.h>
+
+#include "clinic.h"
+
+// Longest command line (without the newline)
+#define COMMAND_LINE_MAX 256
+
+// Output buffer used in batch mode
+#define COMMAND_OUTPUT_BUFFER (1 << 16)
+
+
+//////////////////////////////////////
+// COMMAND FUNCTIONS
+//////////////////////////////////////
+
+// Commands (patients as "number|name|description|phone", appointments as "patient,year,month,day,hour,minute"):
+//   add-patient name|description|phone       edit-patient number|name|description|phone
+//   remove-patient number                    get-patient number
+//   find-phone phone                         find-name letters
+//   list-patients
+//   add-appointment appointment              remove-appointment appointment
+//   list-appointments [YYYY-MM-DD [YYYY-MM-DD]]  (all, one day or an inclusive range)
+//   save                                     (write the data files and empty the journal)
+//   stats [on|off|reset]                     (timings of the hot paths, see stats.h)
+// Blank lines and lines starting with '#' are skipped
+
+// Runs one command (without the newline) and writes its answer (returns 1 if it succeeded)
+int executeCommand(struct ClinicData* data, const char* command, FILE* out);
+
+// Checks if the command can change the data (returns 1 if it needs exclusive access)
+int commandWrites(const char* command);
+
+// Runs every command of the file ("-" reads stdin), returns # of failed commands (-1 if it can't be read)
+int runBatch(struct ClinicData* data, const char* commandFile, FILE* out);
+
+#endif // !COMMAND_H
@@ -7,6 +7,7 @@ The following functions are all toolbox functions, they can be used to do
 
 #define _CRT_SECURE_NO_WARNINGS
 
+#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 #include "core.h"
@@ -38,7 +39,16 @@ void suspend(void)
 // Makes sure phone number is 10 chars and only number chars
 void displayFormattedPhone (const char *stringPTR)
 {
-    const int first3 = 3;
+    char text[PHONE_FORMAT_LEN + 1];
+
+    text[formatPhone(stringPTR, text)] = '\0';
+    fputs(text, stdout);
+}
+
+// Formats a phone number as "(XXX)XXX-XXXX" into text, returns the number of chars written (no '\0')
+int formatPhone (const char *stringPTR, char *text)
+{
+    const char blank[] = "(___)___-____";
     const int phoneLen = 10;
     int allIntegers = 0;
     int i = 0;
@@ -46,53 +56,34 @@ void displayFormattedPhone (const char *stringPTR)
     // Check if string pointer is null
     if (stringPTR != NULL)
     {
-        while (stringPTR[i] != '\0')
+        // Counts the digits up to the 11th char, a longer string is never a phone number
+        while (i <= phoneLen && stringPTR[i] != '\0')
         {
-            // If the index meets the condition, then update allIntegers.
             if (stringPTR[i] >= '0' && stringPTR[i] <= '9')
             {
-                // Update allIntegers if the condition is met.
                 allIntegers++;
             }
             i++;
-        };
-
-        // If the string length is 10 and all the chars are between ASCII 0 and 9, then it will print those chars.
-        if (strlen(stringPTR) == 10 && allIntegers == 10)
-        {
-            for (i = 0; i < first3; i++)
-            {
-                if (i == 0)
-                {
-                    printf("(");
-                }
-                printf("%c", stringPTR[i]);
-                if (i == 2)
-                {
-                    printf(")");
-                }
-            }
-
-            for (i = first3; i < phoneLen; i++)
-            {
-                printf("%c", stringPTR[i]);
-                // If the iterator is equal to 5 then print the dash.
-                if (i == 5)
-                {
-                    printf("-");
-                }
-            }
-        }
-        else
-        {
-            printf("(___)___-____");
         }
     }
+
+    // If the string length is 10 and all the chars are between ASCII 0 and 9, then it will use those chars.
+    if (i == phoneLen && allIntegers == phoneLen)
+    {
+        text[0] = '(';
+        memcpy(text + 1, stringPTR, 3);
+        text[4] = ')';
+        memcpy(text + 5, stringPTR + 3, 3);
+        text[8] = '-';
+        memcpy(text + 9, stringPTR + 6, 4);
+    }
     else
     {
-        printf("(___)___-____");
+        memcpy(text, blank, PHONE_FORMAT_LEN);
     }
-};
+
+    return PHONE_FORMAT_LEN;
+}
 
 //////////////////////////////////////
 // USER INPUT FUNCTIONS
@@ -246,18 +237,25 @@ void inputCString (char *stringPTR, int minChars, int maxChars, int mode)
     } while (flag == 0);
 };
 
+// Gets a phone number of exactly maxLength digits, asking again until one is entered
 void inputPhoneNumber (char *stringPTR, int maxLength)
 {
     char enteredString[15];
     int flag = 0;
+    int digits;
 
     do {
 
         // takes up till 100 characters as a string till a \n
-        scanf(" %15[^\n]", enteredString);
+        scanf(" %14[^\n]", enteredString);
         clearInputBuffer();
 
-        if (strlen(enteredString) != maxLength)
+        for (digits = 0; isdigit((unsigned char)enteredString[digits]); digits++)
+        {
+            ; // counts the leading digits
+        }
+
+        if (strlen(enteredString) != maxLength || digits != maxLength)
         {
             printf("Invalid 10-digit number! Number: ");
         }
@@ -8,6 +8,10 @@ The following functions are all toolbox functions, they can be used to do
 #ifndef CORE_H
 #define CORE_H
 
+// Chars of a formatted phone number, "(XXX)XXX-XXXX"
+#define PHONE_FORMAT_LEN 13
+
+
 //////////////////////////////////////
 // USER INTERFACE FUNCTIONS
 //////////////////////////////////////
@@ -21,6 +25,9 @@ void suspend(void);
 // Makes sure phone number is 10 chars and only number chars
 void displayFormattedPhone (const char *stringPTR);
 
+// Formats a phone number as "(XXX)XXX-XXXX" into text, returns the number of chars written (no '\0')
+int formatPhone (const char *stringPTR, char *text);
+
 
 //////////////////////////////////////
 // USER INPUT FUNCTIONS
@@ -39,6 +46,7 @@ char inputCharOption (const char validChars[]);
 // Checks if inputted string is between the two bounds
 void inputCString (char *stringPTR, int minChars, int maxChars, int mode);
 
+// Gets a phone number of exactly maxLength digits, asking again until one is entered
 void inputPhoneNumber (char *stringPTR, int maxLength);
 
 #endif // !CORE_H
@@ -0,0 +1,965 @@
+/*
+*****************************************************************************
+The following functions read and parse the clinic data files, the formats
+        (one record per line) are the ones used in the data folder.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fileio.h"
+#include "index.h"
+#include "stats.h"
+
+
+// Progress of an import, shared with the line handlers
+struct ImportState
+{
+    const char* datafile;
+    struct ClinicData* data;
+    int records;
+    int errors;
+};
+
+// Work given to one import thread: a run of whole lines, parsed into its own record buffer
+struct ImportWorker
+{
+    const char* begin;
+    const char* end;
+    int appointments;       // parse appointment lines (patient lines otherwise)
+    void* records;          // parsed records, in file order
+    int count;
+    int capacity;
+    long lines;             // lines in the run
+    int errors;
+    long errorLines[IMPORT_MAX_ERRORS];
+    int failed;             // ran out of memory
+};
+
+// Appointments being streamed, collected into a batch for the handler
+struct AppointmentStream
+{
+    struct ImportState state;       // the file and its malformed line count
+    AppointmentBatchHandler handler;
+    void* context;
+    struct Appointment* batch;
+    int count;
+    long records;
+};
+
+// Output file being exported, written through a large buffer
+struct ExportFile
+{
+    int fd;
+    char* buffer;
+    size_t used;
+    int failed;
+};
+
+
+// Reads an unsigned decimal number up to the cursor's end (returns 1 if there were digits and it fits an int)
+static int scanNumber(const char** cursor, const char* end, int* value)
+{
+    const char* start = *cursor;
+    long number = 0;
+
+    while (*cursor < end && **cursor >= '0' && **cursor <= '9' && number <= 214748364L)
+    {
+        number = number * 10 + (**cursor - '0');
+        (*cursor)++;
+    }
+
+    *value = (int)number;
+
+    return *cursor > start && number <= 2147483647L && (*cursor == end || **cursor < '0' || **cursor > '9');
+}
+
+// Reads a number followed by the delimiter (returns 1 if both were found)
+static int scanNumberField(const char** cursor, const char* end, char delimiter, int* value)
+{
+    int found = scanNumber(cursor, end, value) && *cursor < end && **cursor == delimiter;
+
+    if (found)
+    {
+        (*cursor)++;
+    }
+
+    return found;
+}
+
+// Copies the text up to the delimiter (or the end) into the field (returns 1 if it has minChars to maxChars chars)
+static int scanTextField(const char** cursor, const char* end, char delimiter, char* field, int minChars, int maxChars)
+{
+    const char* stop = memchr(*cursor, delimiter, end - *cursor);
+    int length;
+
+    if (stop == NULL)
+    {
+        stop = end;
+    }
+
+    length = (int)(stop - *cursor);
+
+    if (length >= minChars && length <= maxChars)
+    {
+        memcpy(field, *cursor, length);
+        field[length] = '\0';
+    }
+
+    *cursor = stop < end ? stop + 1 : stop;
+
+    return length >= minChars && length <= maxChars;
+}
+
+// Reports a line that could not be parsed (only the first IMPORT_MAX_ERRORS are shown)
+static void reportMalformed(struct ImportState* state, long lineNumber, const char* recordType)
+{
+    state->errors++;
+
+    if (state->errors <= IMPORT_MAX_ERRORS)
+    {
+        fprintf(stderr, "ERROR: %s line %ld: malformed %s record skipped\n", state->datafile, lineNumber, recordType);
+    }
+}
+
+// Appends a patientData.txt line to the patient table
+static int importPatientLine(const char* line, const char* end, long lineNumber, void* context)
+{
+    struct ImportState* state = context;
+    struct Patient patient;
+    int added = 1;
+
+    if (line == end || (end - line == 1 && *line == '\r'))
+    {
+        ; // blank line
+    }
+    else if (!parsePatientLine(line, end, &patient))
+    {
+        reportMalformed(state, lineNumber, "patient");
+    }
+    else if (reservePatients(state->data, state->data->maxPatient + 1) &&
+             storePatient(state->data, state->data->maxPatient, &patient))
+    {
+        state->data->maxPatient++;
+        state->records++;
+    }
+    else
+    {
+        fprintf(stderr, "ERROR: Not enough memory to import %s!\n", state->datafile);
+        added = 0;
+    }
+
+    return added;
+}
+
+// Hands the collected batch of appointments to the stream handler (returns its result)
+static int flushStream(struct AppointmentStream* stream)
+{
+    int reading = stream->count == 0 || stream->handler(stream->batch, stream->count, stream->context);
+
+    stream->records += stream->count;
+    stream->count = 0;
+
+    return reading;
+}
+
+// Adds an appointmentData.txt line to the stream's batch, handing the batch over once it is full
+static int streamAppointmentLine(const char* line, const char* end, long lineNumber, void* context)
+{
+    struct AppointmentStream* stream = context;
+    int reading = 1;
+
+    if (line == end || (end - line == 1 && *line == '\r'))
+    {
+        ; // blank line
+    }
+    else if (!parseAppointmentLine(line, end, &stream->batch[stream->count]))
+    {
+        reportMalformed(&stream->state, lineNumber, "appointment");
+    }
+    else if (++stream->count == STREAM_BATCH_SIZE)
+    {
+        reading = flushStream(stream);
+    }
+
+    return reading;
+}
+
+// Appends a batch of streamed appointments to the appointment table (returns 0 if out of memory)
+static int appendAppointments(const struct Appointment* batch, int count, void* context)
+{
+    struct ImportState* state = context;
+    struct ClinicData* data = state->data;
+    int added = reserveAppointments(data, data->maxAppointments + count);
+    int i;
+
+    for (i = 0; added && i < count; i++)
+    {
+        data->appointmentPatients[data->maxAppointments] = batch[i].patientNum;
+        data->appointmentTimes[data->maxAppointments] = appointmentKey(&batch[i]);
+        data->maxAppointments++;
+        state->records++;
+    }
+
+    if (!added)
+    {
+        fprintf(stderr, "ERROR: Not enough memory to import %s!\n", state->datafile);
+    }
+
+    return added;
+}
+
+// Parses a run of lines into the worker's own record buffer (thread entry point)
+static void* runImportWorker(void* argument)
+{
+    struct ImportWorker* worker = argument;
+    const size_t recordSize = worker->appointments ? sizeof(struct Appointment) : sizeof(struct Patient);
+    const char* line = worker->begin;
+    const char* end;
+    struct Patient patient;
+    struct Appointment appoint;
+    void* grown;
+    int parsed;
+
+    while (line < worker->end && !worker->failed)
+    {
+        end = memchr(line, '\n', worker->end - line);
+
+        if (end == NULL)
+        {
+            end = worker->end;
+        }
+
+        worker->lines++;
+
+        if (line == end || (end - line == 1 && *line == '\r'))
+        {
+            ; // blank line
+        }
+        else
+        {
+            parsed = worker->appointments ? parseAppointmentLine(line, end, &appoint) : parsePatientLine(line, end, &patient);
+
+            if (!parsed)
+            {
+                if (worker->errors < IMPORT_MAX_ERRORS)
+                {
+                    worker->errorLines[worker->errors] = worker->lines;
+                }
+
+                worker->errors++;
+            }
+            else
+            {
+                if (worker->count == worker->capacity)
+                {
+                    grown = realloc(worker->records, recordSize * (worker->capacity > 0 ? worker->capacity * 2 : 1024));
+
+                    if (grown != NULL)
+                    {
+                        worker->records = grown;
+                        worker->capacity = worker->capacity > 0 ? worker->capacity * 2 : 1024;
+                    }
+                    else
+                    {
+                        worker->failed = 1;
+                    }
+                }
+
+                if (!worker->failed)
+                {
+                    memcpy((char*)worker->records + recordSize * worker->count,
+                           worker->appointments ? (void*)&appoint : (void*)&patient, recordSize);
+                    worker->count++;
+                }
+            }
+        }
+
+        line = end + 1;
+    }
+
+    return NULL;
+}
+
+// Imports a memory mapped file with the number of threads, appending the records in file order
+// (returns the number of records, -1 if the file can't be mapped)
+static int importParallel(const char* datafile, struct ClinicData* data, int threads, int appointments)
+{
+    struct ImportState state = { datafile, data, 0, 0 };
+    struct ImportWorker* workers = NULL;
+    pthread_t* handles = NULL;
+    int* started = NULL;
+    struct stat info;
+    const char* file = MAP_FAILED;
+    const char* split;
+    const struct Appointment* appoint;
+    long lineBase = 0;
+    int firstPatient = data->maxPatient;
+    int total = 0;
+    int failed = 0;
+    int fd;
+    int i;
+    int j;
+
+    fd = open(datafile, O_RDONLY);
+
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        file = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    workers = calloc(threads, sizeof(*workers));
+    handles = calloc(threads, sizeof(*handles));
+    started = calloc(threads, sizeof(*started));
+
+    if (file != MAP_FAILED && workers != NULL && handles != NULL && started != NULL)
+    {
+        // Even splits, each moved forward to the start of the next line
+        for (i = 0; i < threads; i++)
+        {
+            workers[i].appointments = appointments;
+            workers[i].begin = i == 0 ? file : workers[i - 1].end;
+            split = file + (size_t)info.st_size / threads * (i + 1);
+
+            if (i == threads - 1 || split <= workers[i].begin)
+            {
+                split = i == threads - 1 ? file + info.st_size : workers[i].begin;
+            }
+            else
+            {
+                split = memchr(split - 1, '\n', file + info.st_size - (split - 1));
+                split = split == NULL ? file + info.st_size : split + 1;
+            }
+
+            workers[i].end = split;
+        }
+
+        // A worker that can't get its own thread is run on this one
+        for (i = 0; i < threads; i++)
+        {
+            started[i] = pthread_create(&handles[i], NULL, runImportWorker, &workers[i]) == 0;
+
+            if (!started[i])
+            {
+                runImportWorker(&workers[i]);
+            }
+        }
+
+        for (i = 0; i < threads; i++)
+        {
+            if (started[i])
+            {
+                pthread_join(handles[i], NULL);
+            }
+
+            failed = failed || workers[i].failed;
+            total += workers[i].count;
+        }
+
+        // Merge the runs in file order, numbering lines across the whole file
+        if (!failed && (appointments ? reserveAppointments(data, data->maxAppointments + total)
+                                     : reservePatients(data, data->maxPatient + total)))
+        {
+            for (i = 0; i < threads; i++)
+            {
+                if (appointments)
+                {
+                    // Split into the patient and packed time columns
+                    for (j = 0; j < workers[i].count; j++)
+                    {
+                        appoint = (const struct Appointment*)workers[i].records + j;
+                        data->appointmentPatients[data->maxAppointments] = appoint->patientNum;
+                        data->appointmentTimes[data->maxAppointments] = appointmentKey(appoint);
+                        data->maxAppointments++;
+                    }
+                }
+                else
+                {
+                    // Names are copied into the name arena, which can still run out of memory
+                    for (j = 0; j < workers[i].count && !failed; j++)
+                    {
+                        failed = !storePatient(data, data->maxPatient, (const struct Patient*)workers[i].records + j);
+                        data->maxPatient += !failed;
+                    }
+                }
+
+                for (j = 0; j < workers[i].errors; j++)
+                {
+                    if (j < IMPORT_MAX_ERRORS)
+                    {
+                        reportMalformed(&state, lineBase + workers[i].errorLines[j], appointments ? "appointment" : "patient");
+                    }
+                    else
+                    {
+                        state.errors++;
+                    }
+                }
+
+                lineBase += workers[i].lines;
+            }
+
+            if (state.errors > IMPORT_MAX_ERRORS)
+            {
+                fprintf(stderr, "ERROR: %s: %d malformed lines skipped in total\n", datafile, state.errors);
+            }
+
+            if (failed)
+            {
+                fprintf(stderr, "ERROR: Not enough memory to import %s!\n", datafile);
+                total = data->maxPatient - firstPatient;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: Not enough memory to import %s!\n", datafile);
+            total = 0;
+        }
+
+        for (i = 0; i < threads; i++)
+        {
+            free(workers[i].records);
+        }
+    }
+    else
+    {
+        total = -1;
+    }
+
+    if (file != MAP_FAILED)
+    {
+        munmap((void*)file, (size_t)info.st_size);
+    }
+
+    free(workers);
+    free(handles);
+    free(started);
+
+    return total;
+}
+
+// Writes out the export buffer (marks the file as failed if it can't be written)
+static void flushExport(struct ExportFile* out)
+{
+    size_t written = 0;
+    ssize_t bytes;
+
+    while (!out->failed && written < out->used)
+    {
+        bytes = write(out->fd, out->buffer + written, out->used - written);
+
+        if (bytes > 0)
+        {
+            written += (size_t)bytes;
+        }
+        else
+        {
+            out->failed = 1;
+        }
+    }
+
+    out->used = 0;
+}
+
+// Writes a record line into the export buffer, flushing it first when it is nearly full
+static void appendExport(struct ExportFile* out, const char* line, int length)
+{
+    if (out->used + length > EXPORT_BUFFER_SIZE)
+    {
+        flushExport(out);
+    }
+
+    memcpy(out->buffer + out->used, line, length);
+    out->used += length;
+}
+
+// Writes the next record line into the buffer, returns its length (0 once the table is done)
+typedef int (*RecordFormatter)(const struct ClinicData* data, int* index, char* line);
+
+// Formats the patient at the index and moves on to the next one
+static int nextPatientLine(const struct ClinicData* data, int* index, char* line)
+{
+    struct Patient patient;
+    int length = 0;
+
+    if (*index < data->maxPatient)
+    {
+        patientAt(data, *index, &patient);
+        length = formatPatientLine(&patient, line);
+        (*index)++;
+    }
+
+    return length;
+}
+
+// Formats the next appointment after the index
+static int nextAppointmentLine(const struct ClinicData* data, int* index, char* line)
+{
+    struct Appointment appoint;
+    int length = 0;
+
+    if (*index < data->maxAppointments)
+    {
+        appointmentAt(data, *index, &appoint);
+        length = formatAppointmentLine(&appoint, line);
+        (*index)++;
+    }
+
+    return length;
+}
+
+// Writes all the records to "<datafile>.tmp", syncs it and renames it over the data file
+// (returns # of records written, -1 on error)
+static int exportRecords(const char* datafile, const struct ClinicData* data, RecordFormatter nextLine)
+{
+    struct ExportFile out = { -1, NULL, 0, 0 };
+    char* tempfile = malloc(strlen(datafile) + 5);
+    char* directory = NULL;
+    char line[EXPORT_LINE_MAX];
+    int length;
+    int index = 0;
+    int records = 0;
+    int fd;
+
+    out.buffer = malloc(EXPORT_BUFFER_SIZE);
+
+    if (tempfile != NULL && out.buffer != NULL)
+    {
+        strcpy(tempfile, datafile);
+        strcat(tempfile, ".tmp");
+        out.fd = open(tempfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    if (out.fd >= 0)
+    {
+        while ((length = nextLine(data, &index, line)) > 0)
+        {
+            appendExport(&out, line, length);
+            records++;
+        }
+
+        flushExport(&out);
+
+        out.failed = out.failed || fsync(out.fd) != 0;
+        out.failed = close(out.fd) != 0 || out.failed;
+
+        // The rename is what makes the new snapshot visible, all at once
+        if (!out.failed && rename(tempfile, datafile) == 0)
+        {
+            // Sync the directory too so the rename itself survives a crash
+            directory = malloc(strlen(datafile) + 1);
+
+            if (directory != NULL)
+            {
+                strcpy(directory, datafile);
+                fd = open(dirname(directory), O_RDONLY);
+
+                if (fd >= 0)
+                {
+                    fsync(fd);
+                    close(fd);
+                }
+            }
+        }
+        else
+        {
+            unlink(tempfile);
+            records = -1;
+        }
+    }
+    else
+    {
+        records = -1;
+    }
+
+    free(directory);
+    free(tempfile);
+    free(out.buffer);
+
+    return records;
+}
+
+// Writes the number in decimal (no padding), returns the number of chars written
+static int formatNumber(int value, char* text)
+{
+    char digits[12];
+    int count = 0;
+    int length = 0;
+    unsigned int number = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+
+    if (value < 0)
+    {
+        text[length++] = '-';
+    }
+
+    do
+    {
+        digits[count++] = (char)('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    while (count > 0)
+    {
+        text[length++] = digits[--count];
+    }
+
+    return length;
+}
+
+// Copies a text field, replacing chars that would break the line format with spaces
+static int formatTextField(const char* field, int maxChars, char* text)
+{
+    int length = 0;
+
+    while (length < maxChars && field[length] != '\0')
+    {
+        text[length] = field[length] == '|' || field[length] == '\n' || field[length] == '\r' ? ' ' : field[length];
+        length++;
+    }
+
+    return length;
+}
+
+
+//////////////////////////////////////
+// PARSING FUNCTIONS
+//////////////////////////////////////
+
+// Parses a patientData.txt line "number|name|description|phone" (returns 1 if the record is valid,
+// the description must be CELL/HOME/WORK/TBD and the phone empty or 10 digits)
+int parsePatientLine(const char* line, const char* end, struct Patient* patient)
+{
+    const struct Patient emptyState = {0};
+    const char* cursor = line;
+
+    *patient = emptyState;
+
+    // Files saved on Windows end their lines with "\r\n"
+    if (end > line && end[-1] == '\r')
+    {
+        end--;
+    }
+
+    return scanNumberField(&cursor, end, '|', &patient->patientNumber) && patient->patientNumber > 0 &&
+           scanTextField(&cursor, end, '|', patient->name, 1, NAME_LEN - 1) &&
+           scanTextField(&cursor, end, '|', patient->phone.description, 1, PHONE_DESC_LEN) &&
+           contactType(patient->phone.description) != -1 &&
+           memchr(cursor, '|', end - cursor) == NULL &&
+           scanTextField(&cursor, end, '|', patient->phone.number, 0, PHONE_LEN) &&
+           (patient->phone.number[0] == '\0' || packPhone(patient->phone.number) != PHONE_NONE);
+}
+
+// Parses an appointmentData.txt line "patient,year,month,day,hour,minute" (returns 1 if the record is valid)
+int parseAppointmentLine(const char* line, const char* end, struct Appointment* appoint)
+{
+    const char* cursor = line;
+
+    if (end > line && end[-1] == '\r')
+    {
+        end--;
+    }
+
+    return scanNumberField(&cursor, end, ',', &appoint->patientNum) && appoint->patientNum > 0 &&
+           scanNumberField(&cursor, end, ',', &appoint->date.year) &&
+           appoint->date.year >= APPOINTMENT_FIRST_YEAR && appoint->date.year <= APPOINTMENT_LAST_YEAR &&
+           scanNumberField(&cursor, end, ',', &appoint->date.month) && appoint->date.month >= 1 && appoint->date.month <= 12 &&
+           scanNumberField(&cursor, end, ',', &appoint->date.day) && appoint->date.day >= 1 &&
+           appoint->date.day <= daysInMonth(appoint->date.year, appoint->date.month) &&
+           scanNumberField(&cursor, end, ',', &appoint->time.hour) && appoint->time.hour <= 23 &&
+           scanNumber(&cursor, end, &appoint->time.min) && appoint->time.min <= 59 &&
+           cursor == end;
+}
+
+// Formats a patient as a patientData.txt line (with the newline), returns the number of chars written
+int formatPatientLine(const struct Patient* patient, char* line)
+{
+    int length = formatNumber(patient->patientNumber, line);
+
+    line[length++] = '|';
+    length += formatTextField(patient->name, NAME_LEN - 1, line + length);
+    line[length++] = '|';
+    length += formatTextField(patient->phone.description, PHONE_DESC_LEN, line + length);
+    line[length++] = '|';
+    length += formatTextField(patient->phone.number, PHONE_LEN, line + length);
+    line[length++] = '\n';
+
+    return length;
+}
+
+// Formats an appointment as an appointmentData.txt line (with the newline), returns the number of chars written
+int formatAppointmentLine(const struct Appointment* appoint, char* line)
+{
+    int length = formatNumber(appoint->patientNum, line);
+
+    line[length++] = ',';
+    length += formatNumber(appoint->date.year, line + length);
+    line[length++] = ',';
+    length += formatNumber(appoint->date.month, line + length);
+    line[length++] = ',';
+    length += formatNumber(appoint->date.day, line + length);
+    line[length++] = ',';
+    length += formatNumber(appoint->time.hour, line + length);
+    line[length++] = ',';
+    length += formatNumber(appoint->time.min, line + length);
+    line[length++] = '\n';
+
+    return length;
+}
+
+// Calls the handler for every line of the file (without the newline), reading it in IMPORT_CHUNK_SIZE blocks
+int readLines(const char* datafile,
+              int (*handler)(const char* line, const char* end, long lineNumber, void* context),
+              void* context)
+{
+    FILE* fp = NULL;
+    char* buffer = NULL;
+    const char* newline;
+    size_t used = 0;
+    size_t start;
+    size_t bytes;
+    long lineNumber = 0;
+    int atEnd = 0;
+    int skipping = 0;
+    int reading = 1;
+    int opened = 0;
+
+    fp = fopen(datafile, "rb");
+    buffer = malloc(IMPORT_CHUNK_SIZE);
+
+    if (fp != NULL && buffer != NULL)
+    {
+        opened = 1;
+
+        while (!atEnd && reading)
+        {
+            bytes = fread(buffer + used, 1, IMPORT_CHUNK_SIZE - used, fp);
+            atEnd = bytes == 0;
+            used += bytes;
+            start = 0;
+
+            // Hand over every complete line in the buffer
+            while (reading && (newline = memchr(buffer + start, '\n', used - start)) != NULL)
+            {
+                if (!skipping)
+                {
+                    lineNumber++;
+                    reading = handler(buffer + start, newline, lineNumber, context);
+                }
+
+                skipping = 0;
+                start = (size_t)(newline - buffer) + 1;
+            }
+
+            if (reading && atEnd && start < used && !skipping)
+            {
+                // Last line of a file that doesn't end with a newline
+                lineNumber++;
+                reading = handler(buffer + start, buffer + used, lineNumber, context);
+                start = used;
+            }
+            else if (reading && start == 0 && used == IMPORT_CHUNK_SIZE)
+            {
+                // A line longer than the whole buffer can't be a valid record: hand it over
+                // (so it is reported) and drop the rest of it
+                if (!skipping)
+                {
+                    lineNumber++;
+                    reading = handler(buffer, buffer + used, lineNumber, context);
+                }
+
+                skipping = 1;
+                start = used;
+            }
+
+            // Keep the partial line for the next block
+            memmove(buffer, buffer + start, used - start);
+            used -= start;
+        }
+    }
+
+    if (fp != NULL)
+    {
+        opened = opened && !ferror(fp);
+        fclose(fp);
+        fp = NULL;
+    }
+
+    free(buffer);
+
+    return opened;
+}
+
+
+//////////////////////////////////////
+// FILE FUNCTIONS
+//////////////////////////////////////
+
+// Import patient data from file, appending to the patient table and indexing it (returns # of records read)
+int importPatients(const char* datafile, struct ClinicData* data)
+{
+    struct ImportState state = { datafile, data, 0, 0 };
+
+    if (!readLines(datafile, importPatientLine, &state))
+    {
+        fprintf(stderr, "Error opening file, please try again!\n");
+    }
+    else if (state.errors > IMPORT_MAX_ERRORS)
+    {
+        fprintf(stderr, "ERROR: %s: %d malformed lines skipped in total\n", datafile, state.errors);
+    }
+
+    buildPatientIndex(data);
+
+    return state.records;
+}
+
+// Import appointment data from file, appending to the appointment table, sort and index it (returns # of records read)
+int importAppointments(const char* datafile, struct ClinicData* data)
+{
+    struct ImportState state = { datafile, data, 0, 0 };
+
+    if (streamAppointments(datafile, appendAppointments, &state) == -1)
+    {
+        fprintf(stderr, "Error opening file, please try again!\n");
+    }
+
+    sortAppointments(data->appointmentPatients, data->appointmentTimes, data->maxAppointments);
+    buildSlotIndex(data);
+
+    return state.records;
+}
+
+// Streams the appointments of an appointmentData.txt file to the handler in batches of up to STREAM_BATCH_SIZE,
+// malformed lines are reported and skipped (returns # of appointments handed over, -1 if the file can't be read)
+long streamAppointments(const char* datafile, AppointmentBatchHandler handler, void* context)
+{
+    struct AppointmentStream stream = { { datafile, NULL, 0, 0 }, handler, context, NULL, 0, 0 };
+    int opened = 0;
+
+    stream.batch = malloc(sizeof(*stream.batch) * STREAM_BATCH_SIZE);
+
+    if (stream.batch != NULL && readLines(datafile, streamAppointmentLine, &stream))
+    {
+        // The last batch is usually a partial one
+        flushStream(&stream);
+        opened = 1;
+
+        if (stream.state.errors > IMPORT_MAX_ERRORS)
+        {
+            fprintf(stderr, "ERROR: %s: %d malformed lines skipped in total\n", datafile, stream.state.errors);
+        }
+    }
+
+    free(stream.batch);
+
+    return opened ? stream.records : -1;
+}
+
+// Export every patient record to file in the import format (returns # of records written, -1 on error)
+int exportPatients(const char* datafile, const struct ClinicData* data)
+{
+    return exportRecords(datafile, data, nextPatientLine);
+}
+
+// Export every appointment record to file in the import format (returns # of records written, -1 on error)
+int exportAppointments(const char* datafile, const struct ClinicData* data)
+{
+    return exportRecords(datafile, data, nextAppointmentLine);
+}
+
+// Export both tables to their data files (returns 1 if both were saved)
+int saveClinicData(const struct ClinicData* data, const char* patientFile, const char* appointmentFile)
+{
+    int saved = exportPatients(patientFile, data) >= 0;
+
+    saved = exportAppointments(appointmentFile, data) >= 0 && saved;
+
+    return saved;
+}
+
+// Gets the default number of import threads (the number of online processors)
+int defaultImportThreads(void)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return processors > 0 ? (int)processors : 1;
+}
+
+// Same as importPatients, splitting the file at line boundaries across the number of threads
+int importPatientsParallel(const char* datafile, struct ClinicData* data, int threads)
+{
+    struct stat info;
+    long long started = startStat();
+    int records = -1;
+
+    // Small files aren't worth a thread per processor
+    if (stat(datafile, &info) == 0 && info.st_size / IMPORT_MIN_THREAD_BYTES + 1 < threads)
+    {
+        threads = (int)(info.st_size / IMPORT_MIN_THREAD_BYTES) + 1;
+    }
+
+    if (threads > 1)
+    {
+        records = importParallel(datafile, data, threads, 0);
+    }
+
+    if (records == -1)
+    {
+        records = importPatients(datafile, data);
+    }
+    else
+    {
+        buildPatientIndex(data);
+    }
+
+    recordStat(STAT_IMPORT_PATIENTS, started);
+
+    return records;
+}
+
+// Same as importAppointments, splitting the file at line boundaries across the number of threads
+int importAppointmentsParallel(const char* datafile, struct ClinicData* data, int threads)
+{
+    struct stat info;
+    long long started = startStat();
+    int records = -1;
+
+    if (stat(datafile, &info) == 0 && info.st_size / IMPORT_MIN_THREAD_BYTES + 1 < threads)
+    {
+        threads = (int)(info.st_size / IMPORT_MIN_THREAD_BYTES) + 1;
+    }
+
+    if (threads > 1)
+    {
+        records = importParallel(datafile, data, threads, 1);
+    }
+
+    if (records == -1)
+    {
+        records = importAppointments(datafile, data);
+    }
+    else
+    {
+        sortAppointments(data->appointmentPatients, data->appointmentTimes, data->maxAppointments);
+        buildSlotIndex(data);
+    }
+
+    recordStat(STAT_IMPORT_APPOINTMENTS, started);
+
+    return records;
+}
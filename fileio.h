@@ -0,0 +1,94 @@
+/*
+*****************************************************************************
+The following functions read and parse the clinic data files, the formats
+        (one record per line) are the ones used in the data folder.
+*****************************************************************************
+*/
+
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include "clinic.h"
+
+// Bytes read from a data file at a time (also the longest line that can be parsed)
+#define IMPORT_CHUNK_SIZE (1 << 20)
+
+// Malformed lines reported one by one before only a total is given
+#define IMPORT_MAX_ERRORS 10
+
+// Smallest part of a file worth handing to its own import thread
+#define IMPORT_MIN_THREAD_BYTES (1 << 20)
+
+// Appointments handed to a stream handler at a time
+#define STREAM_BATCH_SIZE 4096
+
+// Bytes collected before each write when exporting
+#define EXPORT_BUFFER_SIZE (1 << 20)
+
+// Longest line written for one record (including the newline)
+#define EXPORT_LINE_MAX 64
+
+// Gets a batch of streamed appointments, in file order (returns 0 to stop the stream)
+typedef int (*AppointmentBatchHandler)(const struct Appointment* batch, int count, void* context);
+
+
+//////////////////////////////////////
+// PARSING FUNCTIONS
+//////////////////////////////////////
+
+// Parses a patientData.txt line "number|name|description|phone" (returns 1 if the record is valid,
+// the description must be CELL/HOME/WORK/TBD and the phone empty or 10 digits)
+int parsePatientLine(const char* line, const char* end, struct Patient* patient);
+
+// Parses an appointmentData.txt line "patient,year,month,day,hour,minute" (returns 1 if the record is valid)
+int parseAppointmentLine(const char* line, const char* end, struct Appointment* appoint);
+
+// Formats a patient as a patientData.txt line (with the newline), returns the number of chars written
+int formatPatientLine(const struct Patient* patient, char* line);
+
+// Formats an appointment as an appointmentData.txt line (with the newline), returns the number of chars written
+int formatAppointmentLine(const struct Appointment* appoint, char* line);
+
+// Calls the handler for every line of the file (without the newline), reading it in
+// IMPORT_CHUNK_SIZE blocks; a handler result of 0 stops the read (returns 0 if the file can't be read)
+int readLines(const char* datafile,
+              int (*handler)(const char* line, const char* end, long lineNumber, void* context),
+              void* context);
+
+
+//////////////////////////////////////
+// FILE FUNCTIONS
+//////////////////////////////////////
+
+// Import patient data from file, appending to the patient table and indexing it (returns # of records read)
+int importPatients(const char* datafile, struct ClinicData* data);
+
+// Import appointment data from file, appending to the appointment table, sort and index it (returns # of records read)
+int importAppointments(const char* datafile, struct ClinicData* data);
+
+// Streams the appointments of an appointmentData.txt file to the handler in batches of up to STREAM_BATCH_SIZE,
+// malformed lines are reported and skipped. Only a read block and one batch are held at a time, so any size of
+// file can be streamed (returns # of appointments handed over, -1 if the file can't be read).
+long streamAppointments(const char* datafile, AppointmentBatchHandler handler, void* context);
+
+// Gets the default number of import threads (the number of online processors)
+int defaultImportThreads(void);
+
+// Same as importPatients, splitting the file at line boundaries across the number of threads
+// (records keep their file order, 1 thread or small files use importPatients)
+int importPatientsParallel(const char* datafile, struct ClinicData* data, int threads);
+
+// Same as importAppointments, splitting the file at line boundaries across the number of threads
+int importAppointmentsParallel(const char* datafile, struct ClinicData* data, int threads);
+
+// Export every patient record to file in the import format (returns # of records written, -1 on error)
+// The records are written to "<datafile>.tmp" which then replaces the file, so it is never left half written
+int exportPatients(const char* datafile, const struct ClinicData* data);
+
+// Export every appointment record to file in the import format (returns # of records written, -1 on error)
+int exportAppointments(const char* datafile, const struct ClinicData* data);
+
+// Export both tables to their data files (returns 1 if both were saved)
+int saveClinicData(const struct ClinicData* data, const char* patientFile, const char* appointmentFile);
+
+#endif // !FILEIO_H
@@ -0,0 +1,266 @@
+/*
+*****************************************************************************
+Generates synthetic patientData.txt and appointmentData.txt files of any
+ size for the benchmarks. Patients come in households sharing a last name
+  and home phone, appointments fill the weekdays from 2000-01-01 in time
+  order, one per timeslot, with mornings busier than afternoons.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "clinic.h"
+#include "fileio.h"
+#include "index.h"
+
+// Bytes buffered by each output file
+#define GENERATE_BUFFER_SIZE (1 << 20)
+
+// Share of the timeslots booked on an average weekday (more appointments than fit make the days denser)
+#define GENERATE_FILL 0.7
+
+// Chance that a patient joins the household of the patient before them
+#define GENERATE_HOUSEHOLD 0.3
+
+// First appointment day
+#define GENERATE_FIRST_YEAR 2000
+
+static const char* const firstNames[] = {
+    "Ada", "Ben", "Cleo", "Dev", "Eli", "Fay", "Gus", "Hana", "Ivan", "Jade", "Kai", "Lena", "Milo",
+    "Nora", "Omar", "Pia", "Quin", "Rosa", "Sam", "Tess", "Uma", "Vic", "Wren", "Xia", "Yuri", "Zoe"
+};
+
+static const char* const lastNames[] = {
+    "Abbott", "Baker", "Chen", "Diaz", "Evans", "Fox", "Garcia", "Hughes", "Ito", "Jones", "Kim",
+    "Lopez", "Meyer", "Nguyen", "Okafor", "Patel", "Quinn", "Rossi", "Singh", "Tanaka", "Usman",
+    "Vargas", "Walsh", "Xu", "Young", "Zhang"
+};
+
+
+// Gets the next pseudo-random number (xorshift64*, the same seed always gives the same files)
+static unsigned long long nextRandom(unsigned long long* state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+// Gets a pseudo-random number from 0 up to (not including) limit
+static long long randomBelow(unsigned long long* state, long long limit)
+{
+    return (long long)(nextRandom(state) >> 11) % limit;
+}
+
+// Gets a pseudo-random fraction from 0 up to (not including) 1
+static double randomFraction(unsigned long long* state)
+{
+    return (double)(nextRandom(state) >> 11) / 9007199254740992.0;
+}
+
+// Opens "<directory>/<name>" for writing through a large buffer (returns NULL if it can't be created)
+static FILE* openOutput(const char* directory, const char* name)
+{
+    char path[4096];
+    FILE* fp = NULL;
+
+    if (snprintf(path, sizeof(path), "%s/%s", directory, name) < (int)sizeof(path))
+    {
+        fp = fopen(path, "w");
+    }
+
+    if (fp != NULL)
+    {
+        setvbuf(fp, NULL, _IOFBF, GENERATE_BUFFER_SIZE);
+    }
+    else
+    {
+        printf("ERROR: Unable to create %s/%s!\n", directory, name);
+    }
+
+    return fp;
+}
+
+// Writes patients 1 to count (returns 1 on success)
+static int generatePatients(FILE* fp, long count, unsigned long long* random)
+{
+    static const char* const descriptions[] = { "CELL", "HOME", "WORK", "TBD" };
+    struct Patient patient = { 0 };
+    char line[EXPORT_LINE_MAX];
+    const char* lastName = lastNames[0];
+    long long phone = 0;
+    double pick;
+    long i;
+
+    for (i = 1; i <= count; i++)
+    {
+        patient.patientNumber = (int)i;
+
+        // A household shares the last name and the home phone of its first member
+        if (i > 1 && phone > 0 && randomFraction(random) < GENERATE_HOUSEHOLD)
+        {
+            strcpy(patient.phone.description, "HOME");
+        }
+        else
+        {
+            lastName = lastNames[randomBelow(random, sizeof(lastNames) / sizeof(lastNames[0]))];
+            pick = randomFraction(random);
+            strcpy(patient.phone.description, descriptions[pick < 0.55 ? 0 : pick < 0.75 ? 1 : pick < 0.9 ? 2 : 3]);
+            phone = pick < 0.9 ? 2000000000LL + randomBelow(random, 8000000000LL) : 0;
+        }
+
+        snprintf(patient.name, sizeof(patient.name), "%s %s",
+                 firstNames[randomBelow(random, sizeof(firstNames) / sizeof(firstNames[0]))], lastName);
+
+        // TBD patients have no number
+        unpackPhone(phone > 0 ? phone : PHONE_NONE, patient.phone.number);
+
+        fwrite(line, 1, formatPatientLine(&patient, line), fp);
+    }
+
+    return !ferror(fp);
+}
+
+// Writes one weekday's appointments, booking each timeslot with the chance in expected[slot] (every timeslot
+// when full is set) and stopping at left, returns how many were written
+static long generateDay(FILE* fp, long day, const double expected[], long left, int full, long patients,
+                        unsigned long long* random)
+{
+    struct Appointment appoint;
+    char line[EXPORT_LINE_MAX];
+    long written = 0;
+    int slot;
+
+    dateFromDayNumber(day, &appoint.date);
+
+    // A timeslot holds a single appointment
+    for (slot = 0; slot < SLOTS_PER_DAY && written < left; slot++)
+    {
+        if (full || randomFraction(random) < expected[slot])
+        {
+            appoint.time.hour = START_HOUR + slot * MINUTE_INTERVAL / 60;
+            appoint.time.min = slot * MINUTE_INTERVAL % 60;
+
+            // A fifth of the visits are made by the first tenth of the patients (the regulars)
+            appoint.patientNum = (int)(1 + randomBelow(random, randomFraction(random) < 0.2 && patients >= 10
+                                                                   ? patients / 10 : patients));
+            fwrite(line, 1, formatAppointmentLine(&appoint, line), fp);
+            written++;
+        }
+    }
+
+    return written;
+}
+
+// Gets the number of weekday timeslots from GENERATE_FIRST_YEAR to APPOINTMENT_LAST_YEAR (the most appointments)
+static long appointmentCapacity(void)
+{
+    long firstDay = dayNumber(GENERATE_FIRST_YEAR, 1, 1);
+    long lastDay = dayNumber(APPOINTMENT_LAST_YEAR, 12, 31);
+    long weekdays = 0;
+    long day;
+
+    for (day = firstDay; day <= lastDay; day++)
+    {
+        weekdays += (day - firstDay + 5) % 7 < 5;
+    }
+
+    return weekdays * SLOTS_PER_DAY;
+}
+
+// Writes count appointments of patients 1 to patients over the weekdays from GENERATE_FIRST_YEAR,
+// in time order (returns 1 on success)
+static int generateAppointments(FILE* fp, long count, long patients, unsigned long long* random)
+{
+    double expected[SLOTS_PER_DAY];
+    double weights = 0;
+    long firstDay = dayNumber(GENERATE_FIRST_YEAR, 1, 1);
+    long lastDay = dayNumber(APPOINTMENT_LAST_YEAR, 12, 31);
+    long weekdays = (long)(count / (SLOTS_PER_DAY * GENERATE_FILL)) + 1;
+    long room = appointmentCapacity();
+    long written = 0;
+    long day;
+    int slot;
+
+    // There are about 261 weekdays a year
+    if (weekdays > (lastDay - firstDay) / 7 * 5)
+    {
+        weekdays = (lastDay - firstDay) / 7 * 5;
+    }
+
+    // Mornings are busier, each timeslot gets a little less than the one before it
+    for (slot = 0; slot < SLOTS_PER_DAY; slot++)
+    {
+        weights += 2 * SLOTS_PER_DAY - slot;
+    }
+
+    for (slot = 0; slot < SLOTS_PER_DAY; slot++)
+    {
+        expected[slot] = (double)count / weekdays * (2 * SLOTS_PER_DAY - slot) / weights;
+        expected[slot] = expected[slot] < 1 ? expected[slot] : 1;
+    }
+
+    // 2000-01-01 was a Saturday. Once the planned weekdays are used up, or what is left would no longer fit
+    // in the timeslots after this day, every timeslot is booked until count is reached
+    for (day = firstDay; written < count && day <= lastDay; day++)
+    {
+        if ((day - firstDay + 5) % 7 < 5)
+        {
+            written += generateDay(fp, day, expected, count - written,
+                                   weekdays <= 0 || count - written > room - SLOTS_PER_DAY, patients, random);
+            weekdays--;
+            room -= SLOTS_PER_DAY;
+        }
+    }
+
+    return !ferror(fp);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* directory = argc > 3 ? argv[3] : ".";
+    unsigned long long random = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+    long patients = argc > 2 ? atol(argv[1]) : 0;
+    long appointments = argc > 2 ? atol(argv[2]) : -1;
+    FILE* patientFile = NULL;
+    FILE* appointmentFile = NULL;
+    int status = 1;
+
+    // xorshift needs a non-zero state
+    random = random != 0 ? random : 0x9E3779B97F4A7C15ull;
+
+    if (patients < 1 || patients > 2147483647L || appointments < 0)
+    {
+        printf("Usage: %s PATIENTS APPOINTMENTS [DIRECTORY [SEED]]\n", argv[0]);
+    }
+    else if (appointments > appointmentCapacity())
+    {
+        printf("ERROR: At most %ld appointments fit in the weekday timeslots!\n", appointmentCapacity());
+    }
+    else
+    {
+        patientFile = openOutput(directory, "patientData.txt");
+        appointmentFile = patientFile != NULL ? openOutput(directory, "appointmentData.txt") : NULL;
+    }
+
+    if (appointmentFile != NULL)
+    {
+        status = !(generatePatients(patientFile, patients, &random) &&
+                   generateAppointments(appointmentFile, appointments, patients, &random));
+    }
+
+    status = (patientFile != NULL && fclose(patientFile) != 0) || status;
+    status = (appointmentFile != NULL && fclose(appointmentFile) != 0) || status;
+
+    if (status && appointmentFile != NULL)
+    {
+        printf("ERROR: Unable to write the data files!\n");
+    }
+
+    return status;
+}
@@ -0,0 +1,1162 @@
+/*
+*****************************************************************************
+The following functions maintain the lookup indexes owned by ClinicData,
+  they must be kept in sync whenever a record is added/removed/imported.
+*****************************************************************************
+*/
+
+#include <stdlib.h>
+
+#include "index.h"
+#include "stats.h"
+
+// Empty slot marker in the patient number table
+#define EMPTY_SLOT -1
+
+// Empty entry marker in the phone table (packed phone numbers are never negative)
+#define EMPTY_PHONE -1
+
+// Empty entry marker in the timeslot table (day numbers are never negative)
+#define EMPTY_DAY -1
+
+
+// Spreads a patient/day number over the table (both are often sequential)
+static unsigned int hashNumber(int number, int tableSize)
+{
+    unsigned int hash = (unsigned int)number * 0x9E3779B1u;
+
+    hash ^= hash >> 16;
+
+    return hash & (unsigned int)(tableSize - 1);
+}
+
+// Finds the table position holding the patient number (or the empty position where it belongs)
+static int probePatient(const struct ClinicData* data, int patientNumber)
+{
+    const int mask = data->patientTableSize - 1;
+    int position = hashNumber(patientNumber, data->patientTableSize);
+
+    while (data->patientTable[position] != EMPTY_SLOT &&
+           data->patientNumbers[data->patientTable[position]] != patientNumber)
+    {
+        position = (position + 1) & mask;
+    }
+
+    return position;
+}
+
+// Resizes the patient number table to hold at least the number of patients (returns 1 on success)
+static int resizePatientTable(struct ClinicData* data, int patients)
+{
+    int i;
+    int size = 16;
+    int oldSize = data->patientTableSize;
+    int* oldTable = data->patientTable;
+    int* table;
+
+    // Keep the table at most half full so probe sequences stay short
+    while (size < patients * 2)
+    {
+        size *= 2;
+    }
+
+    table = malloc(sizeof(*table) * size);
+
+    if (table != NULL)
+    {
+        for (i = 0; i < size; i++)
+        {
+            table[i] = EMPTY_SLOT;
+        }
+
+        data->patientTable = table;
+        data->patientTableSize = size;
+
+        for (i = 0; i < oldSize; i++)
+        {
+            if (oldTable[i] != EMPTY_SLOT)
+            {
+                data->patientTable[probePatient(data, data->patientNumbers[oldTable[i]])] = oldTable[i];
+            }
+        }
+
+        releaseData(data, oldTable);
+    }
+
+    return table != NULL;
+}
+
+// Spreads a packed phone number over the table
+static unsigned int hashPhone(long long phone, int tableSize)
+{
+    unsigned long long hash = (unsigned long long)phone * 0x9E3779B97F4A7C15ull;
+
+    return (unsigned int)(hash >> 32) & (unsigned int)(tableSize - 1);
+}
+
+// Finds the phone table position holding the phone number (or the empty position where it belongs)
+static int probePhone(const struct ClinicData* data, long long phone)
+{
+    const int mask = data->phoneTableSize - 1;
+    int position = hashPhone(phone, data->phoneTableSize);
+
+    while (data->phoneTable[position].phone != EMPTY_PHONE && data->phoneTable[position].phone != phone)
+    {
+        position = (position + 1) & mask;
+    }
+
+    return position;
+}
+
+// Resizes the phone table to hold at least the number of phone numbers (returns 1 on success)
+static int resizePhoneTable(struct ClinicData* data, int phones)
+{
+    int i;
+    int size = 16;
+    int oldSize = data->phoneTableSize;
+    struct PhoneSlot* oldTable = data->phoneTable;
+    struct PhoneSlot* table;
+
+    while (size < phones * 2)
+    {
+        size *= 2;
+    }
+
+    table = malloc(sizeof(*table) * size);
+
+    if (table != NULL)
+    {
+        for (i = 0; i < size; i++)
+        {
+            table[i].phone = EMPTY_PHONE;
+            table[i].first = EMPTY_SLOT;
+        }
+
+        data->phoneTable = table;
+        data->phoneTableSize = size;
+
+        for (i = 0; i < oldSize; i++)
+        {
+            if (oldTable[i].phone != EMPTY_PHONE)
+            {
+                data->phoneTable[probePhone(data, oldTable[i].phone)] = oldTable[i];
+            }
+        }
+
+        releaseData(data, oldTable);
+    }
+
+    return table != NULL;
+}
+
+// Sets up an empty phone index sized for the patient table (returns 1 on success)
+static int createPhoneIndex(struct ClinicData* data)
+{
+    if (data->patientCapacity > 0)
+    {
+        data->phoneNext = malloc(sizeof(*data->phoneNext) * data->patientCapacity);
+    }
+
+    if (data->phoneNext == NULL || !resizePhoneTable(data, data->maxPatient))
+    {
+        freePhoneIndex(data);
+    }
+
+    return data->phoneTable != NULL;
+}
+
+// Maps a name char to its trigram letter (1-36 for letters/digits, 0 for anything separating words)
+static int trigramLetter(char c)
+{
+    int letter = 0;
+
+    if (c >= 'a' && c <= 'z')
+    {
+        letter = c - 'a' + 1;
+    }
+    else if (c >= 'A' && c <= 'Z')
+    {
+        letter = c - 'A' + 1;
+    }
+    else if (c >= '0' && c <= '9')
+    {
+        letter = c - '0' + 27;
+    }
+
+    return letter;
+}
+
+// Gets the distinct trigrams of a name, sorted (returns how many there are)
+// Each word is padded with 2 separators in front, so "  s", " sh" and "sha" start "Shaggy"
+// and short prefixes still have trigrams to match
+static int nameTrigrams(const char* name, int trigrams[NAME_TRIGRAMS_MAX])
+{
+    int i;
+    int j;
+    int letter;
+    int previous = 0;
+    int before = 0;
+    int count = 0;
+    int trigram;
+
+    for (i = 0; i < NAME_LEN && name[i] != '\0'; i++)
+    {
+        letter = trigramLetter(name[i]);
+
+        if (letter == 0)
+        {
+            previous = 0;
+            before = 0;
+        }
+        else
+        {
+            trigram = (before * TRIGRAM_LETTERS + previous) * TRIGRAM_LETTERS + letter;
+
+            // Insertion sort, dropping repeats (names are short)
+            for (j = count; j > 0 && trigrams[j - 1] > trigram; j--)
+            {
+                trigrams[j] = trigrams[j - 1];
+            }
+
+            if (j > 0 && trigrams[j - 1] == trigram)
+            {
+                for (; j < count; j++)
+                {
+                    trigrams[j] = trigrams[j + 1];
+                }
+            }
+            else
+            {
+                trigrams[j] = trigram;
+                count++;
+            }
+
+            before = previous;
+            previous = letter;
+        }
+    }
+
+    return count;
+}
+
+// Counts the trigrams two sorted trigram lists have in common
+static int commonTrigrams(const int first[], int firstCount, const int second[], int secondCount)
+{
+    int i = 0;
+    int j = 0;
+    int common = 0;
+
+    while (i < firstCount && j < secondCount)
+    {
+        if (first[i] == second[j])
+        {
+            common++;
+            i++;
+            j++;
+        }
+        else if (first[i] < second[j])
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+
+    return common;
+}
+
+// Checks if a word of the name starts with the query, ignoring case (returns 1 if one does)
+static int nameHasPrefix(const char* name, const char* query)
+{
+    int i;
+    int j;
+    int found = 0;
+
+    for (i = 0; !found && i < NAME_LEN && name[i] != '\0'; i++)
+    {
+        if (trigramLetter(name[i]) != 0 && (i == 0 || trigramLetter(name[i - 1]) == 0))
+        {
+            for (j = 0; query[j] != '\0' && i + j < NAME_LEN &&
+                        trigramLetter(name[i + j]) != 0 && trigramLetter(name[i + j]) == trigramLetter(query[j]); j++)
+            {
+                ;
+            }
+
+            found = j > 0 && query[j] == '\0';
+        }
+    }
+
+    return found;
+}
+
+// Adds a candidate to the ranked matches if it beats the last one kept (matches stay best first)
+static void rankMatch(int matches[], int ranks[], int* count, int maxMatches, int index, int rank)
+{
+    int i = *count;
+
+    // Earlier patients win ties, they are offered first
+    if (i < maxMatches || rank > ranks[i - 1] || (rank == ranks[i - 1] && index < matches[i - 1]))
+    {
+        if (i == maxMatches)
+        {
+            i--;
+        }
+        else
+        {
+            (*count)++;
+        }
+
+        while (i > 0 && (ranks[i - 1] < rank || (ranks[i - 1] == rank && matches[i - 1] > index)))
+        {
+            matches[i] = matches[i - 1];
+            ranks[i] = ranks[i - 1];
+            i--;
+        }
+
+        matches[i] = index;
+        ranks[i] = rank;
+    }
+}
+
+// Finds the timeslot table position holding the day (or the empty position where it belongs)
+static int probeDay(const struct ClinicData* data, long day)
+{
+    const int mask = data->daySlotsSize - 1;
+    int position = hashNumber((int)day, data->daySlotsSize);
+
+    while (data->daySlots[position].day != EMPTY_DAY && data->daySlots[position].day != day)
+    {
+        position = (position + 1) & mask;
+    }
+
+    return position;
+}
+
+// Resizes the timeslot table to hold at least the number of days (returns 1 on success)
+static int resizeSlotTable(struct ClinicData* data, int days)
+{
+    int i;
+    int size = 16;
+    int oldSize = data->daySlotsSize;
+    struct DaySlots* oldSlots = data->daySlots;
+    struct DaySlots* slots;
+
+    while (size < days * 2)
+    {
+        size *= 2;
+    }
+
+    slots = malloc(sizeof(*slots) * size);
+
+    if (slots != NULL)
+    {
+        for (i = 0; i < size; i++)
+        {
+            slots[i].day = EMPTY_DAY;
+            slots[i].taken = 0;
+        }
+
+        data->daySlots = slots;
+        data->daySlotsSize = size;
+
+        for (i = 0; i < oldSize; i++)
+        {
+            if (oldSlots[i].day != EMPTY_DAY)
+            {
+                data->daySlots[probeDay(data, oldSlots[i].day)] = oldSlots[i];
+            }
+        }
+
+        releaseData(data, oldSlots);
+    }
+
+    return slots != NULL;
+}
+
+// Gets the timeslot number of a minute of the day (returns -1 if it is not on a slot boundary)
+static int minuteSlot(int minuteOfDay)
+{
+    int minutes = minuteOfDay - START_HOUR * 60;
+    int slot = -1;
+
+    if (minutes >= 0 && minutes % MINUTE_INTERVAL == 0 && minutes / MINUTE_INTERVAL < SLOTS_PER_DAY)
+    {
+        slot = minutes / MINUTE_INTERVAL;
+    }
+
+    return slot;
+}
+
+// Sets a timeslot's bit in the day's bitmap, adding the day to the table if needed
+static void markDaySlot(struct ClinicData* data, long day, int slot)
+{
+    int position = probeDay(data, day);
+
+    if (data->daySlots[position].day == EMPTY_DAY)
+    {
+        // Grow before the table gets more than half full (dropping the bitmaps if that fails)
+        if ((data->daySlotsUsed + 1) * 2 > data->daySlotsSize)
+        {
+            if (resizeSlotTable(data, data->daySlotsUsed + 1))
+            {
+                position = probeDay(data, day);
+            }
+            else
+            {
+                freeSlotIndex(data);
+            }
+        }
+
+        if (data->daySlots != NULL)
+        {
+            data->daySlots[position].day = day;
+            data->daySlotsUsed++;
+        }
+    }
+
+    if (data->daySlots != NULL)
+    {
+        data->daySlots[position].taken |= 1u << slot;
+    }
+}
+
+// Builds a day's timeslot bitmap from its appointments in the calendar index
+static unsigned int scanDaySlots(const struct ClinicData* data, long day)
+{
+    int i;
+    int first = 0;
+    int count;
+    int slot;
+    unsigned int taken = 0;
+
+    count = findAppointmentRange(data, day, day, &first);
+
+    for (i = first; i < first + count; i++)
+    {
+        slot = minuteSlot((int)(data->appointmentTimes[i] % MINUTES_PER_DAY));
+
+        if (slot >= 0)
+        {
+            taken |= 1u << slot;
+        }
+    }
+
+    return taken;
+}
+
+
+//////////////////////////////////////
+// PATIENT NUMBER INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Builds the patient number index from the patient array (returns 1 on success, 0 if out of memory)
+int buildPatientIndex(struct ClinicData* data)
+{
+    int i;
+
+    freePatientIndex(data);
+
+    // The phone and name indexes are optional, searches scan the table without them
+    createPhoneIndex(data);
+    data->nameIndex = calloc(NAME_TRIGRAMS, sizeof(*data->nameIndex));
+
+    if (resizePatientTable(data, data->maxPatient))
+    {
+        for (i = 0; i < data->maxPatient; i++)
+        {
+            indexPatient(data, i);
+        }
+    }
+
+    return data->patientTable != NULL;
+}
+
+// Releases the patient number, phone and name indexes (lookups fall back to a linear scan)
+void freePatientIndex(struct ClinicData* data)
+{
+    releaseData(data, data->patientTable);
+    data->patientTable = NULL;
+    data->patientTableSize = 0;
+    data->patientTableUsed = 0;
+
+    freePhoneIndex(data);
+    freeNameIndex(data);
+}
+
+// Adds the patient stored at the array index to the patient number index
+void indexPatient(struct ClinicData* data, int index)
+{
+    int position;
+
+    // Grow before the table gets more than half full (dropping the index if that fails)
+    if (data->patientTable != NULL && (data->patientTableUsed + 1) * 2 > data->patientTableSize &&
+        !resizePatientTable(data, data->patientTableUsed + 1))
+    {
+        freePatientIndex(data);
+    }
+
+    if (data->patientTable != NULL && data->patientNumbers[index] != 0)
+    {
+        position = probePatient(data, data->patientNumbers[index]);
+
+        // The first record imported with a duplicate patient number keeps the entry
+        if (data->patientTable[position] == EMPTY_SLOT)
+        {
+            data->patientTable[position] = index;
+            data->patientTableUsed++;
+
+            indexPhone(data, index);
+            indexName(data, index);
+        }
+    }
+}
+
+// Removes the patient stored at the array index from the patient number index
+void unindexPatient(struct ClinicData* data, int index)
+{
+    const int mask = data->patientTableSize - 1;
+    int hole;
+    int position;
+    int home;
+
+    if (data->patientTable != NULL && data->patientNumbers[index] != 0)
+    {
+        hole = probePatient(data, data->patientNumbers[index]);
+
+        if (data->patientTable[hole] == index)
+        {
+            unindexPhone(data, index);
+            unindexName(data, index);
+
+            // Backward shift deletion: pull later entries of the probe chain into the hole
+            // so lookups never need tombstones
+            position = (hole + 1) & mask;
+
+            while (data->patientTable[position] != EMPTY_SLOT)
+            {
+                home = hashNumber(data->patientNumbers[data->patientTable[position]],
+                                         data->patientTableSize);
+
+                if (((position - home) & mask) >= ((position - hole) & mask))
+                {
+                    data->patientTable[hole] = data->patientTable[position];
+                    hole = position;
+                }
+
+                position = (position + 1) & mask;
+            }
+
+            data->patientTable[hole] = EMPTY_SLOT;
+            data->patientTableUsed--;
+        }
+    }
+}
+
+// Looks up the patient array index by patient number (returns -1 if not found)
+int lookupPatient(const struct ClinicData* data, int patientNumber)
+{
+    int index = -1;
+
+    if (data->patientTable != NULL && patientNumber != 0)
+    {
+        index = data->patientTable[probePatient(data, patientNumber)];
+    }
+
+    return index;
+}
+
+
+//////////////////////////////////////
+// PHONE NUMBER INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Packs a 10 digit phone number into an integer (returns -1 if it isn't exactly 10 digits)
+long long packPhone(const char* number)
+{
+    long long phone = 0;
+    int i;
+
+    for (i = 0; i < PHONE_LEN && number[i] >= '0' && number[i] <= '9'; i++)
+    {
+        phone = phone * 10 + (number[i] - '0');
+    }
+
+    return i == PHONE_LEN && number[i] == '\0' ? phone : -1;
+}
+
+// Unpacks a phone number back into its 10 digits (an empty string for PHONE_NONE)
+void unpackPhone(long long phone, char* number)
+{
+    int i;
+
+    if (phone == PHONE_NONE)
+    {
+        number[0] = '\0';
+    }
+    else
+    {
+        for (i = PHONE_LEN - 1; i >= 0; i--)
+        {
+            number[i] = (char)('0' + phone % 10);
+            phone /= 10;
+        }
+
+        number[PHONE_LEN] = '\0';
+    }
+}
+
+// Releases the phone index (phone searches fall back to a linear scan)
+void freePhoneIndex(struct ClinicData* data)
+{
+    releaseData(data, data->phoneTable);
+    releaseData(data, data->phoneNext);
+    data->phoneTable = NULL;
+    data->phoneNext = NULL;
+    data->phoneTableSize = 0;
+    data->phoneTableUsed = 0;
+}
+
+// Adds the patient stored at the array index under its phone number
+void indexPhone(struct ClinicData* data, int index)
+{
+    long long phone = data->patientPhones[index];
+    int position;
+    int previous = EMPTY_SLOT;
+    int next;
+
+    if (data->phoneTable != NULL && (data->phoneTableUsed + 1) * 2 > data->phoneTableSize &&
+        !resizePhoneTable(data, data->phoneTableUsed + 1))
+    {
+        freePhoneIndex(data);
+    }
+
+    // Patients without a (complete) phone number aren't indexed
+    if (data->phoneTable != NULL && phone != PHONE_NONE && data->patientNumbers[index] != 0)
+    {
+        position = probePhone(data, phone);
+        next = data->phoneTable[position].first;
+
+        if (data->phoneTable[position].phone == EMPTY_PHONE)
+        {
+            data->phoneTable[position].phone = phone;
+            data->phoneTableUsed++;
+        }
+
+        // Keep each chain in patient table order, the order a full scan would list them
+        while (next != EMPTY_SLOT && next < index)
+        {
+            previous = next;
+            next = data->phoneNext[next];
+        }
+
+        data->phoneNext[index] = next;
+
+        if (previous == EMPTY_SLOT)
+        {
+            data->phoneTable[position].first = index;
+        }
+        else
+        {
+            data->phoneNext[previous] = index;
+        }
+    }
+}
+
+// Removes the patient stored at the array index from its phone number's list
+// (call this BEFORE the patient's phone number is changed or cleared)
+void unindexPhone(struct ClinicData* data, int index)
+{
+    const int mask = data->phoneTableSize - 1;
+    long long phone = data->patientPhones[index];
+    int hole;
+    int position;
+    int home;
+    int previous = EMPTY_SLOT;
+    int next;
+
+    if (data->phoneTable != NULL && phone != PHONE_NONE && data->patientNumbers[index] != 0)
+    {
+        hole = probePhone(data, phone);
+        next = data->phoneTable[hole].first;
+
+        while (next != EMPTY_SLOT && next != index)
+        {
+            previous = next;
+            next = data->phoneNext[next];
+        }
+
+        if (next == index && previous != EMPTY_SLOT)
+        {
+            data->phoneNext[previous] = data->phoneNext[index];
+        }
+        else if (next == index)
+        {
+            data->phoneTable[hole].first = data->phoneNext[index];
+        }
+
+        // The last patient with the number is gone, remove the number (backward shift deletion)
+        if (data->phoneTable[hole].phone != EMPTY_PHONE && data->phoneTable[hole].first == EMPTY_SLOT)
+        {
+            position = (hole + 1) & mask;
+
+            while (data->phoneTable[position].phone != EMPTY_PHONE)
+            {
+                home = hashPhone(data->phoneTable[position].phone, data->phoneTableSize);
+
+                if (((position - home) & mask) >= ((position - hole) & mask))
+                {
+                    data->phoneTable[hole] = data->phoneTable[position];
+                    hole = position;
+                }
+
+                position = (position + 1) & mask;
+            }
+
+            data->phoneTable[hole].phone = EMPTY_PHONE;
+            data->phoneTable[hole].first = EMPTY_SLOT;
+            data->phoneTableUsed--;
+        }
+    }
+}
+
+// Gets the patient array index of the first patient with the packed phone number (returns -1 if none)
+int lookupPhone(const struct ClinicData* data, long long phone)
+{
+    long long started = startStat();
+    int index = -1;
+
+    if (data->phoneTable != NULL && phone != -1)
+    {
+        index = data->phoneTable[probePhone(data, phone)].first;
+    }
+
+    recordStat(STAT_PHONE_SEARCH, started);
+
+    return index;
+}
+
+// Gets the patient array index of the next patient with the same phone number (returns -1 after the last)
+int nextPhonePatient(const struct ClinicData* data, int index)
+{
+    return data->phoneNext[index];
+}
+
+
+//////////////////////////////////////
+// PATIENT NAME INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Releases the name index (name searches fall back to a linear scan)
+void freeNameIndex(struct ClinicData* data)
+{
+    int i;
+
+    if (data->nameIndex != NULL)
+    {
+        for (i = 0; i < NAME_TRIGRAMS; i++)
+        {
+            releaseData(data, data->nameIndex[i].slots);
+        }
+    }
+
+    free(data->nameIndex);
+    data->nameIndex = NULL;
+}
+
+// Adds the patient stored at the array index to the posting list of each trigram of its name
+void indexName(struct ClinicData* data, int index)
+{
+    int trigrams[NAME_TRIGRAMS_MAX];
+    int count;
+    int i;
+    int capacity;
+    int* slots;
+    struct NamePostings* postings;
+
+    if (data->nameIndex != NULL && data->patientNumbers[index] != 0)
+    {
+        count = nameTrigrams(patientName(data, index), trigrams);
+
+        for (i = 0; data->nameIndex != NULL && i < count; i++)
+        {
+            postings = &data->nameIndex[trigrams[i]];
+
+            if (postings->count == postings->capacity)
+            {
+                capacity = postings->capacity > 0 ? postings->capacity * 2 : 4;
+                slots = resizeData(data, postings->slots, sizeof(*slots) * postings->capacity, sizeof(*slots) * capacity);
+
+                if (slots != NULL)
+                {
+                    postings->slots = slots;
+                    postings->capacity = capacity;
+                }
+                else
+                {
+                    freeNameIndex(data);
+                }
+            }
+
+            if (data->nameIndex != NULL)
+            {
+                postings->slots[postings->count] = index;
+                postings->count++;
+            }
+        }
+    }
+}
+
+// Removes the patient stored at the array index from its name's posting lists
+// (call this BEFORE the patient's name is changed or cleared)
+void unindexName(struct ClinicData* data, int index)
+{
+    int trigrams[NAME_TRIGRAMS_MAX];
+    int count;
+    int i;
+    int j;
+    struct NamePostings* postings;
+
+    if (data->nameIndex != NULL && data->patientNumbers[index] != 0)
+    {
+        count = nameTrigrams(patientName(data, index), trigrams);
+
+        for (i = 0; i < count; i++)
+        {
+            postings = &data->nameIndex[trigrams[i]];
+
+            // Searched from the end, where the last patients (the ones releasePatient moves) were added
+            for (j = postings->count - 1; j >= 0 && postings->slots[j] != index; j--)
+            {
+                ;
+            }
+
+            // Order doesn't matter, the last entry fills the gap
+            if (j >= 0)
+            {
+                postings->count--;
+                postings->slots[j] = postings->slots[postings->count];
+            }
+        }
+    }
+}
+
+// Finds the patients whose name best matches the query, best first (returns how many were found)
+// A name matches when it has at least half the query's trigrams, more shared trigrams rank higher
+// and names with a word starting with the query come first among equals
+int searchPatientName(const struct ClinicData* data, const char* query, int matches[], int maxMatches)
+{
+    int queryTrigrams[NAME_TRIGRAMS_MAX];
+    int nameTrigramList[NAME_TRIGRAMS_MAX];
+    int ranks[NAME_MATCHES_MAX];
+    long long started = startStat();
+    int queryCount = nameTrigrams(query, queryTrigrams);
+    int count = 0;
+    int touchedCount = 0;
+    int score;
+    int i;
+    int j;
+    int index;
+    unsigned char* scores = NULL;
+    int* touched = NULL;
+    const struct NamePostings* postings;
+
+    if (maxMatches > NAME_MATCHES_MAX)
+    {
+        maxMatches = NAME_MATCHES_MAX;
+    }
+
+    if (data->nameIndex != NULL && queryCount > 0 && data->maxPatient > 0)
+    {
+        scores = calloc(data->maxPatient, sizeof(*scores));
+        touched = malloc(sizeof(*touched) * data->maxPatient);
+    }
+
+    if (scores != NULL && touched != NULL)
+    {
+        // Count the query trigrams of each patient reached through the posting lists
+        for (i = 0; i < queryCount; i++)
+        {
+            postings = &data->nameIndex[queryTrigrams[i]];
+
+            for (j = 0; j < postings->count; j++)
+            {
+                index = postings->slots[j];
+
+                if (scores[index] == 0)
+                {
+                    touched[touchedCount] = index;
+                    touchedCount++;
+                }
+
+                scores[index]++;
+            }
+        }
+
+        for (i = 0; i < touchedCount; i++)
+        {
+            index = touched[i];
+            score = scores[index];
+
+            if (score * 2 >= queryCount)
+            {
+                rankMatch(matches, ranks, &count, maxMatches, index,
+                          score * 2 + nameHasPrefix(patientName(data, index), query));
+            }
+        }
+    }
+    else if (queryCount > 0)
+    {
+        for (index = 0; index < data->maxPatient; index++)
+        {
+            score = commonTrigrams(queryTrigrams, queryCount, nameTrigramList,
+                                   nameTrigrams(patientName(data, index), nameTrigramList));
+
+            if (score > 0 && score * 2 >= queryCount)
+            {
+                rankMatch(matches, ranks, &count, maxMatches, index,
+                          score * 2 + nameHasPrefix(patientName(data, index), query));
+            }
+        }
+    }
+
+    free(scores);
+    free(touched);
+
+    recordStat(STAT_NAME_SEARCH, started);
+
+    return count;
+}
+
+
+//////////////////////////////////////
+// APPOINTMENT CALENDAR INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Gets the packed key of the appointment at the array index
+unsigned int appointmentKeyAt(const struct ClinicData* data, int index)
+{
+    return data->appointmentTimes[index];
+}
+
+// Finds the first appointment index whose key is >= key (or > key when after is set)
+int searchAppointmentKey(const struct ClinicData* data, unsigned int key, int after)
+{
+    int low = 0;
+    int high = data->maxAppointments;
+    int middle;
+    unsigned int middleKey;
+
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        middleKey = appointmentKeyAt(data, middle);
+
+        if (middleKey < key || (after && middleKey == key))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// Finds the booked appointments from firstDay to lastDay inclusive (day numbers from dayNumber()),
+// sets first to the index of the earliest one and returns how many there are
+int findAppointmentRange(const struct ClinicData* data, long firstDay, long lastDay, int* first)
+{
+    int end;
+    long epoch = dayNumber(APPOINTMENT_FIRST_YEAR, 1, 1);
+    long lastEpochDay = dayNumber(APPOINTMENT_LAST_YEAR, 12, 31);
+
+    // Keys only cover the supported years, days outside them are clamped to the ends
+    firstDay = firstDay < epoch ? epoch : firstDay;
+    lastDay = lastDay > lastEpochDay ? lastEpochDay : lastDay;
+
+    // Appointments are sorted by minute, so every day (week, month...) is one contiguous run
+    if (firstDay > lastEpochDay)
+    {
+        *first = data->maxAppointments;
+    }
+    else
+    {
+        *first = searchAppointmentKey(data, (unsigned int)(firstDay - epoch) * MINUTES_PER_DAY, 0);
+    }
+
+    if (lastDay < firstDay)
+    {
+        end = *first;
+    }
+    else if (lastDay == lastEpochDay)
+    {
+        end = data->maxAppointments;
+    }
+    else
+    {
+        end = searchAppointmentKey(data, (unsigned int)(lastDay + 1 - epoch) * MINUTES_PER_DAY, 0);
+    }
+
+    return end > *first ? end - *first : 0;
+}
+
+// Finds the booked appointment with the same patient, date and time (returns -1 if there is none)
+int findBookedAppointment(const struct ClinicData* data, const struct Appointment* appoint)
+{
+    unsigned int key = appointmentKey(appoint);
+    int first = searchAppointmentKey(data, key, 0);
+
+    return findAppointment(data, appoint->patientNum, first, searchAppointmentKey(data, key, 1) - first);
+}
+
+//////////////////////////////////////
+// APPOINTMENT TIMESLOT INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Builds the per-day timeslot bitmaps from the appointment array (returns 1 on success, 0 if out of memory)
+int buildSlotIndex(struct ClinicData* data)
+{
+    int i;
+    int slot;
+    int days = data->maxAppointments > 0;
+
+    freeSlotIndex(data);
+
+    // The appointments are sorted, so each new day starts where the day number changes
+    for (i = 1; i < data->maxAppointments; i++)
+    {
+        days += appointmentKeyDay(data->appointmentTimes[i]) != appointmentKeyDay(data->appointmentTimes[i - 1]);
+    }
+
+    // Sized for every booked day, so the table is never resized while marking
+    if (resizeSlotTable(data, days))
+    {
+        for (i = 0; i < data->maxAppointments && data->daySlots != NULL; i++)
+        {
+            slot = minuteSlot((int)(data->appointmentTimes[i] % MINUTES_PER_DAY));
+
+            if (slot >= 0)
+            {
+                markDaySlot(data, appointmentKeyDay(data->appointmentTimes[i]), slot);
+            }
+        }
+    }
+
+    return data->daySlots != NULL;
+}
+
+// Releases the timeslot bitmaps (occupancy is then read from the calendar index)
+void freeSlotIndex(struct ClinicData* data)
+{
+    releaseData(data, data->daySlots);
+    data->daySlots = NULL;
+    data->daySlotsSize = 0;
+    data->daySlotsUsed = 0;
+}
+
+// Gets the timeslot number of the appointment's time (returns -1 if it is not on a slot boundary)
+int appointmentSlot(const struct Appointment* appoint)
+{
+    return minuteSlot(appoint->time.hour * 60 + appoint->time.min);
+}
+
+// Marks the appointment's timeslot as booked (call after inserting it)
+void markSlot(struct ClinicData* data, const struct Appointment* appoint)
+{
+    int slot = appointmentSlot(appoint);
+    long day = dayNumber(appoint->date.year, appoint->date.month, appoint->date.day);
+
+    if (data->daySlots != NULL && slot >= 0)
+    {
+        markDaySlot(data, day, slot);
+    }
+}
+
+// Recalculates a day's timeslot bitmap from its appointments (call after removing one)
+void refreshSlots(struct ClinicData* data, long day)
+{
+    int position;
+
+    if (data->daySlots != NULL)
+    {
+        position = probeDay(data, day);
+
+        // Days stay in the table once booked, an emptied day simply has no bits set
+        if (data->daySlots[position].day == day)
+        {
+            data->daySlots[position].taken = scanDaySlots(data, day);
+        }
+    }
+}
+
+// Gets the timeslot bitmap of a day (bit n set = slot n is booked)
+unsigned int daySlotMask(const struct ClinicData* data, long day)
+{
+    unsigned int taken = 0;
+    int position;
+
+    if (data->daySlots != NULL)
+    {
+        position = probeDay(data, day);
+
+        if (data->daySlots[position].day == day)
+        {
+            taken = data->daySlots[position].taken;
+        }
+    }
+    else
+    {
+        taken = scanDaySlots(data, day);
+    }
+
+    return taken;
+}
+
+// Checks if the appointment's timeslot is already booked (returns 1 if taken)
+int isSlotTaken(const struct ClinicData* data, const struct Appointment* appoint)
+{
+    long long started = startStat();
+    int slot = appointmentSlot(appoint);
+    long day = dayNumber(appoint->date.year, appoint->date.month, appoint->date.day);
+    int taken = slot >= 0 && (daySlotMask(data, day) >> slot & 1u) != 0;
+
+    recordStat(STAT_CONFLICT_CHECK, started);
+
+    return taken;
+}
+
+// Moves the appointment's date/time forward to the next free timeslot at or after it
+void findNextFreeSlot(const struct ClinicData* data, struct Appointment* appoint)
+{
+    const unsigned int allSlots = (1u << SLOTS_PER_DAY) - 1;
+    unsigned int freeSlots;
+    int slot = appointmentSlot(appoint);
+    long day = dayNumber(appoint->date.year, appoint->date.month, appoint->date.day);
+
+    if (slot < 0)
+    {
+        slot = 0;
+    }
+
+    // Free slots of the day at or after the requested one, moving on a day while it is fully booked
+    freeSlots = ~daySlotMask(data, day) & allSlots & ~((1u << slot) - 1);
+
+    while (freeSlots == 0)
+    {
+        day++;
+        freeSlots = ~daySlotMask(data, day) & allSlots;
+    }
+
+    for (slot = 0; (freeSlots >> slot & 1u) == 0; slot++)
+    {
+        ; // lowest free slot
+    }
+
+    dateFromDayNumber(day, &appoint->date);
+    appoint->time.hour = START_HOUR + slot * MINUTE_INTERVAL / 60;
+    appoint->time.min = slot * MINUTE_INTERVAL % 60;
+}
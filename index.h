@@ -0,0 +1,143 @@
+/*
+*****************************************************************************
+The following functions maintain the lookup indexes owned by ClinicData,
+  they must be kept in sync whenever a record is added/removed/imported.
+*****************************************************************************
+*/
+
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "clinic.h"
+
+// Letters a name trigram is made of (a separator, a-z and 0-9)
+#define TRIGRAM_LETTERS 37
+
+// Number of distinct name trigrams
+#define NAME_TRIGRAMS (TRIGRAM_LETTERS * TRIGRAM_LETTERS * TRIGRAM_LETTERS)
+
+// Most trigrams a name (or name query) can have, one per letter
+#define NAME_TRIGRAMS_MAX NAME_LEN
+
+// Most matches a name search ranks
+#define NAME_MATCHES_MAX 20
+
+
+//////////////////////////////////////
+// PATIENT NUMBER INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Builds the patient number index from the patient array (returns 1 on success, 0 if out of memory)
+int buildPatientIndex(struct ClinicData* data);
+
+// Releases the patient number, phone and name indexes (lookups fall back to a linear scan)
+void freePatientIndex(struct ClinicData* data);
+
+// Adds the patient stored at the array index to the patient number index (and the phone and name indexes)
+void indexPatient(struct ClinicData* data, int index);
+
+// Removes the patient stored at the array index from the patient number index (and the phone and name indexes)
+// (call this BEFORE the patient record is cleared)
+void unindexPatient(struct ClinicData* data, int index);
+
+// Looks up the patient array index by patient number (returns -1 if not found)
+int lookupPatient(const struct ClinicData* data, int patientNumber);
+
+
+//////////////////////////////////////
+// PHONE NUMBER INDEX FUNCTIONS
+//////////////////////////////////////
+
+// The phone index is built and maintained along with the patient number index
+
+// Packs a 10 digit phone number into an integer (returns -1 if it isn't exactly 10 digits)
+long long packPhone(const char* number);
+
+// Unpacks a phone number back into its 10 digits (an empty string for PHONE_NONE)
+void unpackPhone(long long phone, char* number);
+
+// Releases the phone index (phone searches fall back to a linear scan)
+void freePhoneIndex(struct ClinicData* data);
+
+// Adds the patient stored at the array index under its phone number
+void indexPhone(struct ClinicData* data, int index);
+
+// Removes the patient stored at the array index from its phone number's list
+// (call this BEFORE the patient's phone number is changed or cleared)
+void unindexPhone(struct ClinicData* data, int index);
+
+// Gets the patient array index of the first patient with the packed phone number (returns -1 if none)
+int lookupPhone(const struct ClinicData* data, long long phone);
+
+// Gets the patient array index of the next patient with the same phone number (returns -1 after the last)
+int nextPhonePatient(const struct ClinicData* data, int index);
+
+
+//////////////////////////////////////
+// PATIENT NAME INDEX FUNCTIONS
+//////////////////////////////////////
+
+// The name index is built and maintained along with the patient number index
+
+// Releases the name index (name searches fall back to a linear scan)
+void freeNameIndex(struct ClinicData* data);
+
+// Adds the patient stored at the array index to the posting list of each trigram of its name
+void indexName(struct ClinicData* data, int index);
+
+// Removes the patient stored at the array index from its name's posting lists
+// (call this BEFORE the patient's name is changed or cleared)
+void unindexName(struct ClinicData* data, int index);
+
+// Finds the patients whose name best matches the query, best first (returns how many were found, up to
+// maxMatches and NAME_MATCHES_MAX); partial words and small typos still match
+int searchPatientName(const struct ClinicData* data, const char* query, int matches[], int maxMatches);
+
+
+//////////////////////////////////////
+// APPOINTMENT CALENDAR INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Gets the packed key of the appointment at the array index (the time column is the calendar index)
+unsigned int appointmentKeyAt(const struct ClinicData* data, int index);
+
+// Finds the first appointment index whose key is >= key (or > key when after is set)
+int searchAppointmentKey(const struct ClinicData* data, unsigned int key, int after);
+
+// Finds the booked appointments from firstDay to lastDay inclusive (day numbers from dayNumber()),
+// sets first to the index of the earliest one and returns how many there are
+int findAppointmentRange(const struct ClinicData* data, long firstDay, long lastDay, int* first);
+
+// Finds the booked appointment with the same patient, date and time (returns -1 if there is none)
+int findBookedAppointment(const struct ClinicData* data, const struct Appointment* appoint);
+
+
+//////////////////////////////////////
+// APPOINTMENT TIMESLOT INDEX FUNCTIONS
+//////////////////////////////////////
+
+// Builds the per-day timeslot bitmaps from the appointment array (returns 1 on success, 0 if out of memory)
+int buildSlotIndex(struct ClinicData* data);
+
+// Releases the timeslot bitmaps (occupancy is then read from the calendar index)
+void freeSlotIndex(struct ClinicData* data);
+
+// Gets the timeslot number of the appointment's time (returns -1 if it is not on a slot boundary)
+int appointmentSlot(const struct Appointment* appoint);
+
+// Marks the appointment's timeslot as booked (call after inserting it)
+void markSlot(struct ClinicData* data, const struct Appointment* appoint);
+
+// Recalculates a day's timeslot bitmap from its appointments (call after removing one)
+void refreshSlots(struct ClinicData* data, long day);
+
+// Gets the timeslot bitmap of a day (bit n set = slot n is booked)
+unsigned int daySlotMask(const struct ClinicData* data, long day);
+
+// Checks if the appointment's timeslot is already booked (returns 1 if taken)
+int isSlotTaken(const struct ClinicData* data, const struct Appointment* appoint);
+
+// Moves the appointment's date/time forward to the next free timeslot at or after it
+void findNextFreeSlot(const struct ClinicData* data, struct Appointment* appoint);
+
+#endif // !INDEX_H
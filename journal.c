@@ -0,0 +1,279 @@
+/*
+*****************************************************************************
+  The following functions keep a journal of the changes made since the data
+  files were last saved, one record per line: a 2 char operation ("P+" add,
+ "P=" edit, "P-" remove a patient, "A+"/"A-" book or cancel an appointment)
+ followed by the record in its data file format. Records are written after
+the change is made in memory, then synced in groups: the menus sync once the
+      change is done, the server syncs whenever it has nothing to do.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fileio.h"
+#include "index.h"
+#include "journal.h"
+
+
+// Progress of a journal replay, shared with the line handler
+struct ReplayState
+{
+    const char* journalFile;
+    struct ClinicData* data;
+    int records;
+    int errors;
+};
+
+
+// Applies a patient record, adds and edits both replace the record with that number (returns 1 if applied)
+static int replayPatient(struct ClinicData* data, char op, const struct Patient* patient)
+{
+    int index = lookupPatient(data, patient->patientNumber);
+    int applied = 1;
+
+    if ((op == '+' || op == '=') && index == -1)
+    {
+        index = allocatePatient(data);
+        applied = index != -1 && storePatient(data, index, patient);
+
+        if (applied)
+        {
+            indexPatient(data, index);
+        }
+        else if (index != -1)
+        {
+            releasePatient(data, index);
+        }
+    }
+    else if (op == '+' || op == '=')
+    {
+        unindexPhone(data, index);
+        unindexName(data, index);
+        applied = storePatient(data, index, patient);
+        indexPhone(data, index);
+        indexName(data, index);
+    }
+    else if (op == '-' && index != -1)
+    {
+        unindexPatient(data, index);
+        releasePatient(data, index);
+    }
+    else if (op != '-')
+    {
+        applied = 0;
+    }
+
+    return applied;
+}
+
+// Applies an appointment record, skipping bookings that are already there (returns 1 if applied)
+static int replayAppointment(struct ClinicData* data, char op, const struct Appointment* appoint)
+{
+    int index = findBookedAppointment(data, appoint);
+    int applied = 1;
+
+    if (op == '+' && index == -1)
+    {
+        applied = insertAppointment(data, appoint) != -1;
+    }
+    else if (op == '-' && index != -1)
+    {
+        deleteAppointment(data, index);
+    }
+    else if (op != '+' && op != '-')
+    {
+        applied = 0;
+    }
+
+    return applied;
+}
+
+// Applies a journal line to the data
+static int replayLine(const char* line, const char* end, long lineNumber, void* context)
+{
+    struct ReplayState* state = context;
+    struct Patient patient;
+    struct Appointment appoint;
+    int applied = 0;
+
+    if (line == end || (end - line == 1 && *line == '\r'))
+    {
+        ; // blank line
+    }
+    else
+    {
+        if (end - line > 2 && line[0] == 'P' && parsePatientLine(line + 2, end, &patient))
+        {
+            applied = replayPatient(state->data, line[1], &patient);
+        }
+        else if (end - line > 2 && line[0] == 'A' && parseAppointmentLine(line + 2, end, &appoint))
+        {
+            applied = replayAppointment(state->data, line[1], &appoint);
+        }
+
+        if (applied)
+        {
+            state->records++;
+        }
+        else
+        {
+            state->errors++;
+
+            if (state->errors <= IMPORT_MAX_ERRORS)
+            {
+                fprintf(stderr, "ERROR: %s line %ld: malformed journal record skipped\n", state->journalFile, lineNumber);
+            }
+        }
+    }
+
+    return 1;
+}
+
+// Appends a record line to the journal, syncing or compacting it when it is due
+static void writeRecord(struct ClinicData* data, const char* record, int length)
+{
+    struct Journal* journal = data->journal;
+    time_t now;
+
+    if (journal != NULL && write(journal->fd, record, length) != length)
+    {
+        fprintf(stderr, "ERROR: Unable to write to the journal, changes will only be saved on exit!\n");
+    }
+    else if (journal != NULL)
+    {
+        now = time(NULL);
+        journal->size += length;
+
+        if (journal->unsynced == 0)
+        {
+            journal->firstUnsynced = now;
+        }
+
+        journal->unsynced++;
+
+        // Syncs are shared by every record written in the same window (group commit)
+        if (journal->size >= JOURNAL_COMPACT_BYTES)
+        {
+            compactJournal(data);
+        }
+        else if (journal->unsynced >= JOURNAL_SYNC_RECORDS || now - journal->firstUnsynced >= JOURNAL_SYNC_SECONDS)
+        {
+            syncJournal(journal);
+        }
+    }
+}
+
+
+//////////////////////////////////////
+// JOURNAL FUNCTIONS
+//////////////////////////////////////
+
+// Applies the journal records to the imported data (returns # of records applied)
+int replayJournal(const char* journalFile, struct ClinicData* data)
+{
+    struct ReplayState state = { journalFile, data, 0, 0 };
+
+    // A missing journal just means nothing changed since the last save
+    if (readLines(journalFile, replayLine, &state) && state.errors > IMPORT_MAX_ERRORS)
+    {
+        fprintf(stderr, "ERROR: %s: %d malformed lines skipped in total\n", journalFile, state.errors);
+    }
+
+    return state.records;
+}
+
+// Opens the journal for appending (returns NULL if it can't be opened)
+struct Journal* openJournal(const char* journalFile)
+{
+    struct Journal* journal = malloc(sizeof(*journal));
+
+    if (journal != NULL)
+    {
+        journal->fd = open(journalFile, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        journal->size = 0;
+        journal->unsynced = 0;
+        journal->firstUnsynced = 0;
+
+        if (journal->fd >= 0)
+        {
+            journal->size = (long)lseek(journal->fd, 0, SEEK_END);
+        }
+        else
+        {
+            free(journal);
+            journal = NULL;
+        }
+    }
+
+    return journal;
+}
+
+// Syncs and closes the journal
+void closeJournal(struct Journal* journal)
+{
+    if (journal != NULL)
+    {
+        syncJournal(journal);
+        close(journal->fd);
+        free(journal);
+    }
+}
+
+// Flushes the written records to disk (nothing if there is no journal)
+void syncJournal(struct Journal* journal)
+{
+    if (journal != NULL && journal->unsynced > 0)
+    {
+        fdatasync(journal->fd);
+        journal->unsynced = 0;
+    }
+}
+
+// Saves the data files and empties the journal if there is one (returns 1 on success, the journal is kept on failure)
+int compactJournal(struct ClinicData* data)
+{
+    struct Journal* journal = data->journal;
+    int compacted = data->patientFile != NULL && saveClinicData(data, data->patientFile, data->appointmentFile);
+
+    // The data files now hold every journaled change (if the truncate is lost the replay changes nothing)
+    if (compacted && journal != NULL && ftruncate(journal->fd, 0) == 0)
+    {
+        journal->size = 0;
+        journal->unsynced = 0;
+    }
+    else if (journal != NULL)
+    {
+        compacted = 0;
+    }
+
+    return compacted;
+}
+
+// Records a patient change (op is '+', '=' or '-'), call AFTER the change has been made
+void journalPatient(struct ClinicData* data, char op, const struct Patient* patient)
+{
+    char record[EXPORT_LINE_MAX + 2];
+
+    record[0] = 'P';
+    record[1] = op;
+
+    writeRecord(data, record, 2 + formatPatientLine(patient, record + 2));
+}
+
+// Records an appointment change (op is '+' or '-'), call AFTER the change has been made
+void journalAppointment(struct ClinicData* data, char op, const struct Appointment* appoint)
+{
+    char record[EXPORT_LINE_MAX + 2];
+
+    record[0] = 'A';
+    record[1] = op;
+
+    writeRecord(data, record, 2 + formatAppointmentLine(appoint, record + 2));
+}
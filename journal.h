@@ -0,0 +1,64 @@
+/*
+*****************************************************************************
+  The following functions keep a journal of the changes made since the data
+  files were last saved, one record per line: a 2 char operation ("P+" add,
+ "P=" edit, "P-" remove a patient, "A+"/"A-" book or cancel an appointment)
+ followed by the record in its data file format. Records are written after
+the change is made in memory, then synced in groups: the menus sync once the
+      change is done, the server syncs whenever it has nothing to do.
+*****************************************************************************
+*/
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <time.h>
+
+#include "clinic.h"
+
+// Records written before the journal is synced to disk
+#define JOURNAL_SYNC_RECORDS 32
+
+// Seconds a written record may wait for the next sync while more are written
+#define JOURNAL_SYNC_SECONDS 1
+
+// Journal size that triggers compaction into fresh data files
+#define JOURNAL_COMPACT_BYTES (4L << 20)
+
+// Open journal file (it is compacted into the data files of the ClinicData)
+struct Journal
+{
+    int fd;
+    long size;                  // bytes written since the last compaction
+    int unsynced;               // records written since the last sync
+    time_t firstUnsynced;       // when the oldest of those was written
+};
+
+
+//////////////////////////////////////
+// JOURNAL FUNCTIONS
+//////////////////////////////////////
+
+// Applies the journal records to the imported data (returns # of records applied)
+// Records are idempotent, replaying a journal already contained in the data files changes nothing
+int replayJournal(const char* journalFile, struct ClinicData* data);
+
+// Opens the journal for appending (returns NULL if it can't be opened)
+struct Journal* openJournal(const char* journalFile);
+
+// Syncs and closes the journal
+void closeJournal(struct Journal* journal);
+
+// Flushes the written records to disk (nothing if there is no journal)
+void syncJournal(struct Journal* journal);
+
+// Saves the data files and empties the journal if there is one (returns 1 on success, the journal is kept on failure)
+int compactJournal(struct ClinicData* data);
+
+// Records a patient change (op is '+', '=' or '-'), call AFTER the change has been made
+void journalPatient(struct ClinicData* data, char op, const struct Patient* patient);
+
+// Records an appointment change (op is '+' or '-'), call AFTER the change has been made
+void journalAppointment(struct ClinicData* data, char op, const struct Appointment* appoint);
+
+#endif // !JOURNAL_H
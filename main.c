@@ -1,23 +1,237 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "clinic.h"
+#include "fileio.h"
+#include "command.h"
+#include "journal.h"
+#include "menu.h"
+#include "report.h"
+#include "server.h"
+#include "snapshot.h"
+#include "stats.h"
 
-#define MAX_PETS 20
-#define MAX_APPOINTMENTS 50
+// Initial table sizes, both tables grow as records are added
+#define INITIAL_PATIENTS 64
+#define INITIAL_APPOINTMENTS 256
 
-int main(void)
+// Data files loaded at startup and written back on exit
+#define PATIENT_FILE "data/patientData.txt"
+#define APPOINTMENT_FILE "data/appointmentData.txt"
+
+// Changes made since the data files were last saved
+#define JOURNAL_FILE "data/journal.txt"
+
+int main(int argc, char* argv[])
 {
-    struct Patient pets[MAX_PETS] = { {0} };
-    struct Appointment appoints[MAX_APPOINTMENTS] = { {0} };
-    struct ClinicData data = { pets, MAX_PETS, appoints, MAX_APPOINTMENTS };
+    struct ClinicData data = { 0 };
+    int patientCount = 0;
+    int appointmentCount = 0;
+    int journalCount = 0;
+    int threads = defaultImportThreads();
+    int serverThreads = SERVER_DEFAULT_THREADS;
+    int status = 0;
+    const char* batchFile = NULL;
+    const char* socketPath = NULL;
+    const char* reportFile = NULL;
+    const char* snapshotFile = NULL;
+    const char* convertFile = NULL;
+    const char* summaryFile = NULL;
+    const char* statsFile = NULL;
+    int started = 0;
+    int fromSnapshot = 0;
+    int i;
+
+    // Options: --threads N sets the number of threads used to import the data files (and to serve clients),
+    //          --batch [FILE] runs the commands in the file (or stdin) instead of the menus (see command.h),
+    //          --serve PATH serves the same commands on a Unix domain socket (see server.h),
+    //          --report FILE writes the patient table and the full schedule to the file ("-" is stdout),
+    //          --snapshot FILE starts from the snapshot while it matches the data files, and keeps it current (see snapshot.h),
+    //          --convert FILE writes a snapshot of the data files to the file,
+    //          --summary FILE prints the appointments per month/timeslot of an appointmentData.txt file of any size,
+    //          --stats FILE times the hot paths from the start and writes the timings to the file on exit (see stats.h)
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            threads = atoi(argv[i + 1]);
+            serverThreads = threads;
+            i++;
+        }
+        else if (strcmp(argv[i], "--batch") == 0)
+        {
+            batchFile = "-";
+
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0)
+            {
+                batchFile = argv[i + 1];
+                i++;
+            }
+        }
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc)
+        {
+            socketPath = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+        {
+            reportFile = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+        {
+            snapshotFile = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--convert") == 0 && i + 1 < argc)
+        {
+            convertFile = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--summary") == 0 && i + 1 < argc)
+        {
+            summaryFile = argv[i + 1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+        {
+            statsFile = argv[i + 1];
+            i++;
+        }
+        else
+        {
+            printf("Usage: %s [--threads N] [--snapshot FILE] [--stats FILE] [--batch [FILE] | --serve PATH | --report FILE | --convert FILE | --summary FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Batch answers are written in large blocks rather than line by line
+    if (batchFile != NULL)
+    {
+        setvbuf(stdout, NULL, _IOFBF, COMMAND_OUTPUT_BUFFER);
+    }
+
+    if (statsFile != NULL)
+    {
+        setStatsEnabled(1);
+    }
+
+    // A summary only streams its file, the clinic data isn't loaded
+    if (summaryFile != NULL)
+    {
+        if (writeAppointmentSummary(summaryFile, "-") == -1)
+        {
+            printf("ERROR: Unable to summarize %s!\n", summaryFile);
+            status = 1;
+        }
+    }
+    // A snapshot of the current data files is used in place, otherwise the files are imported
+    else if (snapshotFile != NULL && loadSnapshot(snapshotFile, &data, PATIENT_FILE, APPOINTMENT_FILE))
+    {
+        patientCount = data.maxPatient;
+        appointmentCount = data.maxAppointments;
+        fromSnapshot = 1;
+        started = 1;
+    }
+    else if (initClinicData(&data, INITIAL_PATIENTS, INITIAL_APPOINTMENTS))
+    {
+        patientCount = importPatientsParallel(PATIENT_FILE, &data, threads);
+        appointmentCount = importAppointmentsParallel(APPOINTMENT_FILE, &data, threads);
+        started = 1;
+    }
+
+    if (started)
+    {
+        // Redo the changes of a session that didn't get to save
+        journalCount = replayJournal(JOURNAL_FILE, &data);
+
+        // Batch output only holds the command answers (and a report only the tables)
+        if (batchFile == NULL && reportFile == NULL && convertFile == NULL)
+        {
+            printf("Imported %d patient records...\n", patientCount);
+            printf("Imported %d appointment records...\n", appointmentCount);
+
+            if (journalCount > 0)
+            {
+                printf("Recovered %d journaled changes...\n", journalCount);
+            }
+
+            putchar('\n');
+        }
+
+        data.patientFile = PATIENT_FILE;
+        data.appointmentFile = APPOINTMENT_FILE;
+        data.journal = openJournal(JOURNAL_FILE);
+
+        if (data.journal == NULL)
+        {
+            fprintf(stderr, "ERROR: Unable to open the journal, changes will only be saved on exit!\n\n");
+        }
+        else if (data.journal->size > 0)
+        {
+            // Fold the recovered changes into the data files so the journal starts empty
+            compactJournal(&data);
+        }
+
+        if (socketPath != NULL)
+        {
+            status = !runServer(&data, socketPath, serverThreads);
+        }
+        else if (reportFile != NULL)
+        {
+            if (!writeReport(&data, reportFile))
+            {
+                printf("ERROR: Unable to write the report to %s!\n", reportFile);
+                status = 1;
+            }
+        }
+        else if (convertFile != NULL)
+        {
+            if (!writeSnapshot(convertFile, &data, PATIENT_FILE, APPOINTMENT_FILE))
+            {
+                printf("ERROR: Unable to write the snapshot to %s!\n", convertFile);
+                status = 1;
+            }
+        }
+        else if (batchFile == NULL)
+        {
+            menuMain(&data);
+        }
+        else if (runBatch(&data, batchFile, stdout) == -1)
+        {
+            printf("ERR Unable to read %s\n", batchFile);
+            status = 1;
+        }
+
+        // Write the changes back (the journal is kept if this fails, the old files are never left half written),
+        // an empty journal means the data files already hold everything
+        if ((data.journal == NULL || data.journal->size > 0) && !compactJournal(&data))
+        {
+            printf("ERROR: Unable to save the clinic data files!\n");
+        }
+
+        // The snapshot is rewritten if it couldn't be used or the data files have moved on from it
+        if (snapshotFile != NULL && (!fromSnapshot || !isSnapshotCurrent(snapshotFile, PATIENT_FILE, APPOINTMENT_FILE)) &&
+            !writeSnapshot(snapshotFile, &data, PATIENT_FILE, APPOINTMENT_FILE))
+        {
+            printf("ERROR: Unable to write the snapshot to %s!\n", snapshotFile);
+        }
 
-    int patientCount = importPatients("data/patientData.txt", pets, MAX_PETS);
-    int appointmentCount = importAppointments("data/appointmentData.txt", appoints, MAX_APPOINTMENTS);
+        closeJournal(data.journal);
+        data.journal = NULL;
+    }
+    else if (summaryFile == NULL)
+    {
+        printf("ERROR: Not enough memory to start the clinic system!\n");
+    }
 
-    printf("Imported %d patient records...\n", patientCount);
-    printf("Imported %d appointment records...\n\n", appointmentCount);
+    if (statsFile != NULL && !writeStatsFile(statsFile))
+    {
+        printf("ERROR: Unable to write the statistics to %s!\n", statsFile);
+    }
 
-    menuMain(&data);
+    freeClinicData(&data);
 
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
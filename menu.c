@@ -0,0 +1,861 @@
+/*
+*****************************************************************************
+The following functions are the menus, they prompt for input on stdin, show
+   the records and run the clinic operations of clinic.h on the answers.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "core.h"
+#include "clinic.h"
+#include "index.h"
+#include "journal.h"
+#include "menu.h"
+#include "report.h"
+#include "stats.h"
+
+
+//////////////////////////////////////
+// DISPLAY FUNCTIONS
+//////////////////////////////////////
+
+// Display's the patient table header (table format)
+void displayPatientTableHeader(void)
+{
+    struct Report report;
+
+    openReport(&report, STDOUT_FILENO);
+    reportPatientHeader(&report);
+    closeReport(&report);
+}
+
+// Displays a single patient record in FMT_FORM | FMT_TABLE format
+void displayPatientData(const struct Patient* patient, int fmt)
+{
+    struct Report report;
+
+    openReport(&report, STDOUT_FILENO);
+    reportPatient(&report, patient, fmt);
+    closeReport(&report);
+}
+
+// Display's appointment schedule headers (date-specific or all records)
+void displayScheduleTableHeader(const struct Date* date, int isAllRecords)
+{
+    struct Report report;
+
+    openReport(&report, STDOUT_FILENO);
+    reportScheduleHeader(&report, date, isAllRecords);
+    closeReport(&report);
+}
+
+// Display a single appointment record with patient info. in tabular format
+void displayScheduleData(const struct Patient* patient, const struct Appointment* appoint, int includeDateField)
+{
+    struct Report report;
+
+    openReport(&report, STDOUT_FILENO);
+    reportScheduleRow(&report, patient, appoint, includeDateField);
+    closeReport(&report);
+}
+
+//////////////////////////////////////
+// MENU & ITEM SELECTION FUNCTIONS
+//////////////////////////////////////
+
+// main menu
+void menuMain(struct ClinicData* data)
+{
+    int selection;
+
+    do {
+        printf("Veterinary Clinic System\n"
+               "=========================\n"
+               "1) PATIENT     Management\n"
+               "2) APPOINTMENT Management\n"
+               "3) PERFORMANCE Statistics\n"
+               "-------------------------\n"
+               "0) Exit System\n"
+               "-------------------------\n"
+               "Selection: ");
+        selection = inputIntRange(0, 3);
+        putchar('\n');
+        switch (selection)
+        {
+            case 0:
+                printf("Are you sure you want to exit? (y|n): ");
+                selection = !(inputCharOption("yn") == 'y');
+                putchar('\n');
+                if (!selection)
+                {
+                    printf("Exiting system... Goodbye.\n\n");
+                }
+                break;
+            case 1:
+                menuPatient(data);
+                break;
+            case 2:
+                menuAppointment(data);
+                break;
+            case 3:
+                menuStatistics();
+                break;
+        }
+    } while (selection);
+}
+
+// Menu: Patient Management
+void menuPatient(struct ClinicData* data)
+{
+    int selection;
+
+    do {
+        printf("Patient Management\n"
+               "=========================\n"
+               "1) VIEW   Patient Data\n"
+               "2) SEARCH Patients\n"
+               "3) ADD    Patient\n"
+               "4) EDIT   Patient\n"
+               "5) REMOVE Patient\n"
+               "-------------------------\n"
+               "0) Previous menu\n"
+               "-------------------------\n"
+               "Selection: ");
+        selection = inputIntRange(0, 5);
+        putchar('\n');
+        switch (selection)
+        {
+            case 1:
+                displayAllPatients(data, FMT_TABLE);
+                suspend();
+                break;
+            case 2:
+                searchPatientData(data);
+                break;
+            case 3:
+                addPatient(data);
+                syncJournal(data->journal);
+                suspend();
+                break;
+            case 4:
+                editPatient(data);
+                break;
+            case 5:
+                removePatient(data);
+                syncJournal(data->journal);
+                suspend();
+                break;
+        }
+    } while (selection);
+}
+
+// Menu: Patient edit
+void menuPatientEdit(struct ClinicData* data, int index)
+{
+    struct Patient patient;
+    enum ClinicResult result = CLINIC_OK;
+    int selection;
+
+    do {
+        patientAt(data, index, &patient);
+
+        printf("Edit Patient (%05d)\n"
+               "=========================\n"
+               "1) NAME : %s\n"
+               "2) PHONE: ", patient.patientNumber, patient.name);
+
+        displayFormattedPhone(patient.phone.number);
+
+        printf("\n"
+               "-------------------------\n"
+               "0) Previous menu\n"
+               "-------------------------\n"
+               "Selection: ");
+        selection = inputIntRange(0, 2);
+        putchar('\n');
+
+        if (selection == 1)
+        {
+            printf("Name  : ");
+            inputCString(patient.name, 1, NAME_LEN - 1, 0);
+            result = clinicEditPatient(data, &patient);
+        }
+        else if (selection == 2)
+        {
+            inputPhoneData(&patient.phone);
+            result = clinicEditPatient(data, &patient);
+        }
+
+        if (selection != 0)
+        {
+            // The menu waits for the user next, the change must not wait with it
+            syncJournal(data->journal);
+            putchar('\n');
+
+            if (result == CLINIC_OK)
+            {
+                printf("Patient record updated!\n\n");
+            }
+            else if (result == CLINIC_FULL)
+            {
+                printf("ERROR: Patient listing is FULL!\n\n");
+            }
+            else
+            {
+                printf("ERROR: %s!\n\n", clinicResultMessage(result));
+            }
+        }
+
+    } while (selection);
+}
+
+
+// Menu: Appointment Management
+void menuAppointment(struct ClinicData* data)
+{
+    int selection;
+
+    do {
+        printf("Appointment Management\n"
+               "==============================\n"
+               "1) VIEW   ALL Appointments\n"
+               "2) VIEW   Appointments by DATE\n"
+               "3) ADD    Appointment\n"
+               "4) REMOVE Appointment\n"
+               "------------------------------\n"
+               "0) Previous menu\n"
+               "------------------------------\n"
+               "Selection: ");
+        selection = inputIntRange(0, 4);
+        putchar('\n');
+        switch (selection)
+        {
+            case 1:
+                viewAllAppointments(data);
+                suspend();
+                break;
+            case 2:
+                viewAppointmentSchedule(data);
+                suspend();
+                break;
+            case 3:
+                addAppointment(data);
+                syncJournal(data->journal);
+                suspend();
+                break;
+            case 4:
+                removeAppointment(data);
+                syncJournal(data->journal);
+                suspend();
+                break;
+        }
+    } while (selection);
+}
+
+// Menu: Performance Statistics
+void menuStatistics(void)
+{
+    int selection;
+
+    do {
+        printf("Performance Statistics\n"
+               "=========================\n"
+               "1) VIEW   Statistics\n"
+               "2) %-6s Collection\n"
+               "3) RESET  Statistics\n"
+               "-------------------------\n"
+               "0) Previous menu\n"
+               "-------------------------\n"
+               "Selection: ", statsEnabled() ? "STOP" : "START");
+        selection = inputIntRange(0, 3);
+        putchar('\n');
+        switch (selection)
+        {
+            case 1:
+                displayStats(stdout);
+                suspend();
+                break;
+            case 2:
+                setStatsEnabled(!statsEnabled());
+                printf("Statistics collection %s.\n\n", statsEnabled() ? "started" : "stopped");
+                break;
+            case 3:
+                resetStats();
+                printf("Statistics cleared.\n\n");
+                break;
+        }
+    } while (selection);
+}
+
+// Display's all patient data in the FMT_FORM | FMT_TABLE format
+void displayAllPatients(const struct ClinicData* data, int fmt)
+{
+    struct Report report;
+
+    // The whole table is rendered in a buffer and written in large blocks
+    openReport(&report, STDOUT_FILENO);
+    reportPatients(&report, data, fmt);
+    closeReport(&report);
+}
+
+// Search for a patient record based on patient number or phone number
+void searchPatientData(const struct ClinicData* data)
+{
+    int selection = 0;
+
+    do
+    {
+        printf("Search Options\n");
+        printf("==========================\n");
+        printf("1) By patient number\n");
+        printf("2) By phone number\n");
+        printf("3) By name\n");
+        printf("..........................\n");
+        printf("0) Previous menu\n");
+        printf("..........................\n");
+        printf("Selection: ");
+        selection = inputIntRange(0, 3);
+
+        switch (selection)
+        {
+            case 1:
+                putchar('\n');
+                searchPatientByPatientNumber(data);
+                suspend();
+                break;
+            case 2:
+                searchPatientByPhoneNumber(data);
+                suspend();
+                break;
+            case 3:
+                searchPatientByName(data);
+                suspend();
+                break;
+            default:
+                putchar('\n');
+                break;
+        }
+
+    } while (selection);
+}
+
+// Add a new patient record to the patient array
+void addPatient(struct ClinicData* data)
+{
+    struct Patient patient = {0};
+    enum ClinicResult result;
+
+    // The number shown is the one clinicAddPatient gives out
+    patient.patientNumber = nextPatientNumber(data);
+    inputPatient(&patient);
+    result = clinicAddPatient(data, &patient);
+
+    if (result == CLINIC_OK)
+    {
+        printf("\n*** New patient record added ***\n\n");
+    }
+    else if (result == CLINIC_FULL)
+    {
+        printf("\nERROR: Patient listing is FULL!\n\n");
+    }
+    else
+    {
+        printf("\nERROR: %s!\n\n", clinicResultMessage(result));
+    }
+}
+
+// Edit a patient record from the patient array
+void editPatient(struct ClinicData* data)
+{
+    int index;
+    int patientNumber;
+    printf("Enter the patient number: ");
+    patientNumber = inputInt();
+    putchar('\n');
+
+    index = findPatientIndexByPatientNum(patientNumber, data);
+
+    if (index >= 0)
+    {
+        menuPatientEdit(data, index);
+    }
+    else
+    {
+        printf("\nERROR: Patient record not found!\n\n");
+    }
+
+}
+
+
+// Remove a patient record from the patient array
+void removePatient(struct ClinicData* data)
+{
+    const int FMT = FMT_FORM;
+    int patientNumber = 0;
+    int recordExists = 0;
+    char confirmation;
+    struct Patient removed;
+
+    printf("Enter the patient number: ");
+    patientNumber = inputInt();
+    putchar('\n');
+
+    recordExists = clinicFindPatient(data, patientNumber, &removed) == CLINIC_OK;
+
+    if (recordExists)
+    {
+        displayPatientData(&removed, FMT);
+
+        putchar('\n');
+
+        printf("Are you sure you want to remove this patient record? (y/n): ");
+        confirmation = inputCharOption("yn");
+
+        if(confirmation == 'n')
+        {
+            printf("Operation aborted.\n\n");
+        }
+        else
+        {
+            clinicRemovePatient(data, patientNumber, &removed);
+
+            printf("Patient record has been removed!\n\n");
+        }
+    }
+    else
+    {
+        printf("ERROR: Patient record not found!\n\n");
+    }
+}
+
+// View ALL scheduled appointments
+void viewAllAppointments(struct ClinicData* data)
+{
+    struct Report report;
+    int isAllRecords = 1;
+    int includeDateField = 1;
+    int first;
+    int count;
+
+    clinicSchedule(data, NULL, NULL, &first, &count);
+
+    openReport(&report, STDOUT_FILENO);
+    reportScheduleHeader(&report, NULL, isAllRecords);
+    reportSchedule(&report, data, first, count, includeDateField);
+    reportText(&report, "\n");
+    closeReport(&report);
+
+}
+
+// View appointment schedule for the user input date
+void viewAppointmentSchedule (struct ClinicData *data)
+{
+
+    // Loop Vars
+    int first = 0;
+    int numAppointments = 0;
+    int counter = 0;
+
+    // Temp Struct
+    struct Appointment temp;
+    struct Report report;
+
+    // Get user input for year
+    printf("Year        : ");
+    temp.date.year = inputIntPositive();
+
+    // Get user input for month
+    printf("Month (1-12): ");
+    temp.date.month = inputIntRange(1, 12);
+
+    // Gets user input for day, in the range of the month
+    temp.date.day = inputDay(temp.date.year, temp.date.month);
+
+    putchar('\n');
+
+    displayScheduleTableHeader(&temp.date, TRUE);
+
+    // The calendar index narrows the scan down to the requested day's appointments
+    clinicSchedule(data, &temp.date, &temp.date, &first, &numAppointments);
+
+    openReport(&report, STDOUT_FILENO);
+    counter = reportSchedule(&report, data, first, numAppointments, TRUE);
+    closeReport(&report);
+
+    if (counter == 0)
+    {
+        printf("\n*** No records found ***\n");
+    }
+
+    putchar('\n');
+
+}
+
+// Add an appointment record to the appointment array
+void addAppointment (struct ClinicData *data)
+{
+    // Loop Vars
+    int flag = 0;
+
+    // Vars used to calculate the empty index of the struct arrays
+    int patientIndex = -1;
+
+    // Result of booking the appointment, asked for again while the timeslot is taken
+    enum ClinicResult result = CLINIC_SLOT_TAKEN;
+
+    // Struct used to recieve data, gets assigned later.
+    struct Appointment added;
+
+    // Next free timeslot suggested when the entered one is taken
+    struct Appointment suggested;
+
+    do
+    {
+        printf("Patient Number: ");
+        added.patientNum = inputIntPositive();
+        patientIndex = findPatientIndexByPatientNum(added.patientNum, data);
+
+        if (patientIndex == -1)
+        {
+            printf("ERROR: Patient record not found!\n\n");
+        }
+        else
+        {
+            flag = 1;
+        }
+
+    } while (flag == 0);
+
+
+    // inputAppointment only returns once a bookable time has been entered,
+    // so the booking can only fail on the date, a taken timeslot or memory.
+
+    while (result == CLINIC_SLOT_TAKEN || result == CLINIC_BAD_APPOINTMENT)
+    {
+        inputAppointment(&added);
+        result = clinicAddAppointment(data, &added, &suggested);
+
+        if (result == CLINIC_SLOT_TAKEN)
+        {
+            printf("\nERROR: Appointment timeslot is not available!\n");
+            printf("Next available timeslot: %04d-%02d-%02d %02d:%02d\n\n", suggested.date.year, suggested.date.month,
+                   suggested.date.day, suggested.time.hour, suggested.time.min);
+        }
+        else if (result == CLINIC_BAD_APPOINTMENT)
+        {
+            printf("\nERROR: Appointment date is not on the calendar!\n\n");
+        }
+    }
+
+    if (result == CLINIC_OK)
+    {
+        printf("\n*** Appointment scheduled! ***\n\n");
+    }
+    else
+    {
+        printf("\nERROR: Appointments are full, please contact us to book an appointment!\n");
+    }
+
+    clearInputBuffer();
+
+}
+
+// Remove an appointment record from the appointment array
+void removeAppointment (struct ClinicData *data)
+{
+    // Used to get the return value from function
+    int patientNumber = 0;
+    char selection;
+    struct Date date;
+    struct Appointment removed;
+    struct Patient patient;
+
+        printf("Patient Number: ");
+        scanf("%d", &patientNumber);
+
+        if (clinicFindPatient(data, patientNumber, &patient) == CLINIC_OK)
+        {
+            // Get user input for year
+            printf("Year        : ");
+            date.year = inputIntPositive();
+
+            // Get user input for month
+            printf("Month (1-12): ");
+            date.month = inputIntRange(1, 12);
+
+            // Gets user input for day, in the range of the month
+            date.day = inputDay(date.year, date.month);
+
+            putchar('\n');
+
+            // Display the patient's data
+            displayPatientData(&patient, FALSE);
+
+            if (clinicFindAppointment(data, patientNumber, &date, &removed) == CLINIC_OK)
+            {
+                printf("Are you sure you want to remove this appointment (y,n): ");
+                selection = inputCharOption("yn");
+
+                if (selection == 'y' || selection == 'Y')
+                {
+                    clinicRemoveAppointment(data, &removed);
+                    printf("\nAppointment record has been removed!\n\n");
+                }
+                else
+                {
+                    printf("\n*** Operation Aborted! ***\n\n");
+                }
+            }
+            else
+            {
+                printf("\n*** No Appointments with that date! ***\n\n");
+            }
+        }
+        else
+        {
+            printf("ERROR: Patient record not found!\n\n");
+            clearInputBuffer();
+        }
+}
+
+//////////////////////////////////////
+// UTILITY FUNCTIONS
+//////////////////////////////////////
+
+// Search and display patient record by patient number (form)
+void searchPatientByPatientNumber(const struct ClinicData* data)
+{
+    const int FMT = FMT_FORM;
+    int patientNumber = 0;
+    int value = 0;
+    struct Patient patient;
+
+    printf("Search by patient number: ");
+    patientNumber = inputInt();
+
+    value = clinicFindPatient(data, patientNumber, &patient);
+
+    if(value == CLINIC_OK)
+    {
+        putchar('\n');
+        displayPatientData(&patient, FMT);
+        putchar('\n');
+    }
+    else
+    {
+        printf("\n*** No records found ***\n\n");
+    }
+}
+
+
+// Search and display patient records by phone number (tabular)
+void searchPatientByPhoneNumber(const struct ClinicData* data)
+{
+    const int FMT = FMT_TABLE;
+    char phoneNumber[PHONE_LEN + 1]; // +1 is to accommodate for the NULL terminator
+    long long phone;
+    int i;
+    int found;
+    struct Patient patient;
+
+    printf("\nSearch by phone number: ");
+    inputCString(phoneNumber, 10, 10, 0); // Only accepts up till 10 chars for the number.
+    phone = packPhone(phoneNumber);
+
+    putchar('\n');
+
+    displayPatientTableHeader();
+
+    found = 0; // Resets found counter
+
+    if (data->phoneTable != NULL)
+    {
+        // Family members share numbers, so the index lists every patient with it
+        for (i = lookupPhone(data, phone); i != -1; i = nextPhonePatient(data, i))
+        {
+            patientAt(data, i, &patient);
+            displayPatientData(&patient, FMT);
+            found++;
+        }
+    }
+    else
+    {
+        for (i = 0; i < data->maxPatient; i++)
+        {
+            if(phone != PHONE_NONE && data->patientPhones[i] == phone) // Compares the packed phone numbers
+            {
+                patientAt(data, i, &patient);
+                displayPatientData(&patient, FMT);
+                found++;
+            }
+        }
+    }
+    putchar('\n');
+
+    if(found == 0)
+    {
+        printf("*** No records found ***\n\n");
+    }
+}
+
+// Search and display the patients whose name best matches a few letters (tabular)
+void searchPatientByName(const struct ClinicData* data)
+{
+    const int FMT = FMT_TABLE;
+    char name[NAME_LEN];
+    int matches[NAME_MATCHES_MAX];
+    int found;
+    int i;
+    struct Patient patient;
+
+    printf("\nSearch by name: ");
+    inputCString(name, 1, NAME_LEN - 1, 0);
+
+    putchar('\n');
+
+    displayPatientTableHeader();
+
+    // Ranked best match first, partial words and small typos still match
+    found = searchPatientName(data, name, matches, NAME_MATCHES_MAX);
+
+    for (i = 0; i < found; i++)
+    {
+        patientAt(data, matches[i], &patient);
+        displayPatientData(&patient, FMT);
+    }
+    putchar('\n');
+
+    if(found == 0)
+    {
+        printf("*** No records found ***\n\n");
+    }
+}
+
+//////////////////////////////////////
+// USER INPUT FUNCTIONS
+//////////////////////////////////////
+
+// Get user input for a new patient record
+void inputPatient(struct Patient* patient)
+{
+    printf("Patient Data Input");
+    putchar('\n');
+    printf("------------------");
+    putchar('\n');
+    printf("Number: %05d", patient->patientNumber);
+    putchar('\n');
+    printf("Name  : ");
+    inputCString(patient->name, 1, NAME_LEN - 1, 0);
+    putchar('\n');
+    inputPhoneData(&patient->phone);
+}
+
+
+// Get user input for phone contact information
+void inputPhoneData(struct Phone* phone)
+{
+    int selection;
+
+    printf("Phone Information");
+    putchar('\n');
+    printf("-----------------");
+    putchar('\n');
+    printf("How will the patient like to be contacted?");
+    putchar('\n');
+    printf("1. Cell");
+    putchar('\n');
+    printf("2. Home");
+    putchar('\n');
+    printf("3. Work");
+    putchar('\n');
+    printf("4. TBD");
+    putchar('\n');
+    printf("Selection: ");
+    selection = inputIntRange(1,4);
+
+    switch (selection)
+    {
+        case 1:
+            strcpy(phone->description, "CELL");
+            putchar('\n');
+            printf("Contact: %s", phone->description);
+            putchar('\n');
+            printf("Number : ");
+            inputPhoneNumber(phone->number, PHONE_LEN);
+            break;
+        case 2:
+            strcpy(phone->description, "HOME");
+            putchar('\n');
+            printf("Contact: %s", phone->description);
+            putchar('\n');
+            printf("Number : ");
+            inputPhoneNumber(phone->number, PHONE_LEN);
+            break;
+        case 3:
+            strcpy(phone->description, "WORK");
+            putchar('\n');
+            printf("Contact: %s", phone->description);
+            putchar('\n');
+            printf("Number : ");
+            inputPhoneNumber(phone->number, PHONE_LEN);
+            break;
+        case 4:
+            strcpy(phone->description, "TBD");
+            *phone->number = '\0'; // Sets string to empty
+            break;
+        default:
+            break;
+    }
+}
+
+// Used to input appointment information when adding an appointment, returns a number if setting the data was successful
+int inputAppointment (struct Appointment *appointment)
+{
+    int flag = 0;
+
+    printf("Year        : ");
+    appointment->date.year = inputIntRange(APPOINTMENT_FIRST_YEAR, APPOINTMENT_LAST_YEAR);
+
+    printf("Month (1-12): ");
+    scanf("%d", &appointment->date.month);
+
+    appointment->date.day = inputDay(appointment->date.year, appointment->date.month);
+
+    do
+    {
+        printf("Hour (0-23)  : ");
+        scanf("%d", &appointment->time.hour);
+
+        printf("Minute (0-59): ");
+        scanf("%d", &appointment->time.min);
+
+        flag = 0;
+
+        if ((appointment->time.hour > END_HOUR || appointment->time.hour < START_HOUR) || (appointment->time.hour == END_HOUR && appointment->time.min == MINUTE_INTERVAL) || (appointment->time.min != 0 && appointment->time.min != MINUTE_INTERVAL) )
+        {
+            printf("ERROR: Time must be between %d:00 and %d:00 in %d minute intervals.\n\n", START_HOUR, END_HOUR, MINUTE_INTERVAL);
+        }
+        else
+        {
+            flag = 1;
+        }
+
+    } while (flag == 0);
+
+    return flag;
+
+}
+
+// Get user input for a day of the month (the range depends on the month, accounts for leap year)
+int inputDay (int year, int month)
+{
+    printf("Day (%d-%d)  : ", 1, daysInMonth(year, month));
+
+    return inputIntRange(1, daysInMonth(year, month));
+}
@@ -0,0 +1,112 @@
+/*
+*****************************************************************************
+The following functions are the menus, they prompt for input on stdin, show
+   the records and run the clinic operations of clinic.h on the answers.
+*****************************************************************************
+*/
+
+#ifndef MENU_H
+#define MENU_H
+
+#include "clinic.h"
+
+
+//////////////////////////////////////
+// DISPLAY FUNCTIONS
+//////////////////////////////////////
+
+// Display's the patient table header (table format)
+void displayPatientTableHeader(void);
+
+// Displays a single patient record in FMT_FORM | FMT_TABLE format
+void displayPatientData(const struct Patient* patient, int fmt);
+
+// Display's appointment schedule headers (date-specific or all records)
+void displayScheduleTableHeader(const struct Date* date, int isAllRecords);
+
+// Display a single appointment record with patient info. in tabular format
+void displayScheduleData(const struct Patient* patient,
+                         const struct Appointment* appoint,
+                         int includeDateField);
+
+
+//////////////////////////////////////
+// MENU & ITEM SELECTION FUNCTIONS
+//////////////////////////////////////
+
+// Menu: Main
+void menuMain(struct ClinicData* data);
+
+// Menu: Patient Management
+void menuPatient(struct ClinicData* data);
+
+// Menu: Patient edit (of the patient in the slot)
+void menuPatientEdit(struct ClinicData* data, int index);
+
+// Menu: Appointment Management
+void menuAppointment(struct ClinicData* data);
+
+// Menu: Performance Statistics
+void menuStatistics(void);
+
+// Display's all patient data in the FMT_FORM | FMT_TABLE format
+void displayAllPatients(const struct ClinicData* data, int fmt);
+
+// Search for a patient record based on patient number or phone number
+void searchPatientData(const struct ClinicData* data);
+
+// Add a new patient record to the patient array
+void addPatient(struct ClinicData* data);
+
+// Edit a patient record from the patient array
+void editPatient(struct ClinicData* data);
+
+// Remove a patient record from the patient array
+void removePatient(struct ClinicData* data);
+
+// View ALL scheduled appointments
+void viewAllAppointments (struct ClinicData *data);
+
+// View appointment schedule for the user input date
+void viewAppointmentSchedule (struct ClinicData *data);
+
+// Add an appointment record to the appointment array
+void addAppointment (struct ClinicData *data);
+
+// Remove an appointment record from the appointment array
+void removeAppointment (struct ClinicData *data);
+
+
+
+//////////////////////////////////////
+// UTILITY FUNCTIONS
+//////////////////////////////////////
+
+// Search and display patient record by patient number (form)
+void searchPatientByPatientNumber(const struct ClinicData* data);
+
+// Search and display patient records by phone number (tabular)
+void searchPatientByPhoneNumber(const struct ClinicData* data);
+
+// Search and display the patients whose name best matches a few letters (tabular)
+void searchPatientByName(const struct ClinicData* data);
+
+
+
+//////////////////////////////////////
+// USER INPUT FUNCTIONS
+//////////////////////////////////////
+
+// Get user input for a new patient record
+void inputPatient(struct Patient* patient);
+
+// Get user input for phone contact information
+void inputPhoneData(struct Phone* phone);
+
+// Used to input appointment information when adding an appointment, returns a number if setting the data was successful
+int inputAppointment (struct Appointment *appointment);
+
+// Get user input for a day of the month (the range depends on the month, accounts for leap year)
+int inputDay (int year, int month);
+
+#endif // !MENU_H
@@ -0,0 +1,573 @@
+/*
+*****************************************************************************
+The following functions render the patient and appointment tables shown by
+   the menus. Rows are formatted into a large buffer and written to a file
+   descriptor in big blocks, so a full table costs a few writes instead of
+                      several stdio calls per row.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "core.h"
+#include "fileio.h"
+#include "index.h"
+#include "report.h"
+#include "stats.h"
+
+
+// Appointment counts of a streamed file, the same size whatever the size of the file
+struct AppointmentSummary
+{
+    long months[SUMMARY_YEARS][12];
+    long slots[SLOTS_PER_DAY];
+    long offSlot;                   // booked between the timeslots
+    long total;
+    unsigned int firstKey;          // earliest and latest appointmentKey()
+    unsigned int lastKey;
+};
+
+
+// Writes the buffered rows to the file descriptor
+static void flushReport(struct Report* report)
+{
+    ssize_t written;
+    int done = 0;
+
+    while (!report->failed && done < report->used)
+    {
+        written = write(report->fd, report->buffer + done, report->used - done);
+
+        if (written > 0)
+        {
+            done += (int)written;
+        }
+        else if (written < 0 && errno != EINTR)
+        {
+            report->failed = 1;
+        }
+    }
+
+    report->used = 0;
+}
+
+// Makes room for a row in the buffer, returns where it goes
+static char* reserveRow(struct Report* report)
+{
+    if (report->used + REPORT_ROW_MAX > REPORT_BUFFER_SIZE)
+    {
+        flushReport(report);
+    }
+
+    return report->buffer + report->used;
+}
+
+// Formats a number with at least width digits (zero padded like "%05d"), returns the number of chars written
+static int putNumber(char* text, int value, int width)
+{
+    char digits[12];
+    unsigned int number = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    int count = 0;
+    int length = 0;
+
+    if (value < 0)
+    {
+        text[length++] = '-';
+    }
+
+    do
+    {
+        digits[count++] = (char)('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    while (count < width)
+    {
+        digits[count++] = '0';
+    }
+
+    while (count > 0)
+    {
+        text[length++] = digits[--count];
+    }
+
+    return length;
+}
+
+// Formats a count right aligned in width chars (like "%*ld"), returns the number of chars written
+static int putCount(char* text, long value, int width)
+{
+    char digits[24];
+    int count = 0;
+    int length = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (length < width - count)
+    {
+        text[length++] = ' ';
+    }
+
+    while (count > 0)
+    {
+        text[length++] = digits[--count];
+    }
+
+    return length;
+}
+
+// Copies text, then pads it with spaces to width chars (like "%-15s"), returns the number of chars written
+static int putPadded(char* text, const char* field, int width)
+{
+    int length = (int)strlen(field);
+
+    memcpy(text, field, length);
+
+    while (length < width)
+    {
+        text[length++] = ' ';
+    }
+
+    return length;
+}
+
+// Formats the "(XXX)XXX-XXXX (DESC)" end of a row with the newline, returns the number of chars written
+static int putPhone(char* text, const struct Phone* phone)
+{
+    int length = formatPhone(phone->number, text);
+
+    text[length++] = ' ';
+    text[length++] = '(';
+    length += putPadded(text + length, phone->description, 0);
+    text[length++] = ')';
+    text[length++] = '\n';
+
+    return length;
+}
+
+// Formats a packed appointment key as "YYYY-MM-DD HH:MM", returns the number of chars written
+static int putKey(char* text, unsigned int key)
+{
+    struct Appointment appoint;
+    int length = 0;
+
+    appointmentFromKey(key, &appoint);
+
+    length += putNumber(text + length, appoint.date.year, 4);
+    text[length++] = '-';
+    length += putNumber(text + length, appoint.date.month, 2);
+    text[length++] = '-';
+    length += putNumber(text + length, appoint.date.day, 2);
+    text[length++] = ' ';
+    length += putNumber(text + length, appoint.time.hour, 2);
+    text[length++] = ':';
+    length += putNumber(text + length, appoint.time.min, 2);
+
+    return length;
+}
+
+// Counts a batch of streamed appointments into the summary (always carries on with the stream)
+static int summarizeAppointments(const struct Appointment* batch, int count, void* context)
+{
+    struct AppointmentSummary* summary = context;
+    unsigned int key;
+    int slot;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        key = appointmentKey(&batch[i]);
+        slot = appointmentSlot(&batch[i]);
+
+        summary->months[batch[i].date.year - APPOINTMENT_FIRST_YEAR][batch[i].date.month - 1]++;
+
+        if (slot >= 0)
+        {
+            summary->slots[slot]++;
+        }
+        else
+        {
+            summary->offSlot++;
+        }
+
+        summary->firstKey = summary->total == 0 || key < summary->firstKey ? key : summary->firstKey;
+        summary->lastKey = summary->total == 0 || key > summary->lastKey ? key : summary->lastKey;
+        summary->total++;
+    }
+
+    return 1;
+}
+
+// Adds the appointments per month table, one row per year that has any
+static void reportMonths(struct Report* report, const struct AppointmentSummary* summary)
+{
+    char* row;
+    long yearTotal;
+    int length;
+    int year;
+    int month;
+
+    reportText(report, "Year    Jan    Feb    Mar    Apr    May    Jun    Jul    Aug    Sep    Oct    Nov    Dec    Total\n"
+                       "---- ------ ------ ------ ------ ------ ------ ------ ------ ------ ------ ------ ------ --------\n");
+
+    for (year = 0; year < SUMMARY_YEARS; year++)
+    {
+        for (month = 0, yearTotal = 0; month < 12; month++)
+        {
+            yearTotal += summary->months[year][month];
+        }
+
+        if (yearTotal > 0)
+        {
+            row = reserveRow(report);
+            length = putNumber(row, APPOINTMENT_FIRST_YEAR + year, 4);
+
+            // The space keeps counts too wide for their column apart
+            for (month = 0; month < 12; month++)
+            {
+                row[length++] = ' ';
+                length += putCount(row + length, summary->months[year][month], 6);
+            }
+
+            row[length++] = ' ';
+            length += putCount(row + length, yearTotal, 8);
+            row[length++] = '\n';
+            report->used += length;
+        }
+    }
+}
+
+// Adds the appointments per timeslot table
+static void reportSlots(struct Report* report, const struct AppointmentSummary* summary)
+{
+    char* row;
+    int length;
+    int slot;
+
+    reportText(report, "\nTime    Booked\n"
+                       "----- --------\n");
+
+    for (slot = 0; slot < SLOTS_PER_DAY; slot++)
+    {
+        row = reserveRow(report);
+        length = putNumber(row, START_HOUR + slot * MINUTE_INTERVAL / 60, 2);
+        row[length++] = ':';
+        length += putNumber(row + length, slot * MINUTE_INTERVAL % 60, 2);
+        row[length++] = ' ';
+        length += putCount(row + length, summary->slots[slot], 8);
+        row[length++] = '\n';
+        report->used += length;
+    }
+
+    row = reserveRow(report);
+    length = putPadded(row, "Other", 0);
+    row[length++] = ' ';
+    length += putCount(row + length, summary->offSlot, 8);
+    row[length++] = '\n';
+    report->used += length;
+}
+
+
+//////////////////////////////////////
+// REPORT FUNCTIONS
+//////////////////////////////////////
+
+// Starts a report on the file descriptor (stdout is flushed first when it is the target)
+void openReport(struct Report* report, int fd)
+{
+    // Anything already printed with stdio has to come out before the report
+    if (fd == STDOUT_FILENO)
+    {
+        fflush(stdout);
+    }
+
+    report->fd = fd;
+    report->used = 0;
+    report->failed = 0;
+}
+
+// Writes out what is left in the buffer (returns 1 if the whole report was written)
+int closeReport(struct Report* report)
+{
+    flushReport(report);
+
+    return !report->failed;
+}
+
+// Adds text to the report
+void reportText(struct Report* report, const char* text)
+{
+    int length = (int)strlen(text);
+    int part;
+
+    while (length > 0)
+    {
+        if (report->used == REPORT_BUFFER_SIZE)
+        {
+            flushReport(report);
+        }
+
+        part = REPORT_BUFFER_SIZE - report->used < length ? REPORT_BUFFER_SIZE - report->used : length;
+        memcpy(report->buffer + report->used, text, part);
+        report->used += part;
+        text += part;
+        length -= part;
+    }
+}
+
+// Adds the patient table header (table format)
+void reportPatientHeader(struct Report* report)
+{
+    reportText(report, "Pat.# Name            Phone#\n"
+                       "----- --------------- --------------------\n");
+}
+
+// Adds a patient record in FMT_FORM | FMT_TABLE format
+void reportPatient(struct Report* report, const struct Patient* patient, int fmt)
+{
+    char* row = reserveRow(report);
+    int length = 0;
+
+    if (fmt == FMT_FORM)
+    {
+        length += putPadded(row + length, "Name  : ", 0);
+        length += putPadded(row + length, patient->name, 0);
+        length += putPadded(row + length, "\nNumber: ", 0);
+        length += putNumber(row + length, patient->patientNumber, 5);
+        length += putPadded(row + length, "\nPhone : ", 0);
+    }
+    else
+    {
+        length += putNumber(row + length, patient->patientNumber, 5);
+        row[length++] = ' ';
+        length += putPadded(row + length, patient->name, 15);
+        row[length++] = ' ';
+    }
+
+    length += putPhone(row + length, &patient->phone);
+    report->used += length;
+}
+
+// Adds the appointment schedule header (date-specific or all records)
+void reportScheduleHeader(struct Report* report, const struct Date* date, int isAllRecords)
+{
+    char* row;
+    int length = 0;
+
+    reportText(report, "Clinic Appointments for the Date: ");
+
+    if (isAllRecords)
+    {
+        reportText(report, "<ALL>\n\n"
+                           "Date       Time  Pat.# Name            Phone#\n"
+                           "---------- ----- ----- --------------- --------------------\n");
+    }
+    else
+    {
+        row = reserveRow(report);
+        length += putNumber(row + length, date->year, 4);
+        row[length++] = '-';
+        length += putNumber(row + length, date->month, 2);
+        row[length++] = '-';
+        length += putNumber(row + length, date->day, 2);
+        row[length++] = '\n';
+        row[length++] = '\n';
+        report->used += length;
+
+        reportText(report, "Time  Pat.# Name            Phone#\n"
+                           "----- ----- --------------- --------------------\n");
+    }
+}
+
+// Adds an appointment row with its patient's details
+void reportScheduleRow(struct Report* report, const struct Patient* patient,
+                       const struct Appointment* appoint, int includeDateField)
+{
+    char* row = reserveRow(report);
+    int length = 0;
+
+    if (includeDateField)
+    {
+        length += putNumber(row + length, appoint->date.year, 4);
+        row[length++] = '-';
+        length += putNumber(row + length, appoint->date.month, 2);
+        row[length++] = '-';
+        length += putNumber(row + length, appoint->date.day, 2);
+        row[length++] = ' ';
+    }
+
+    length += putNumber(row + length, appoint->time.hour, 2);
+    row[length++] = ':';
+    length += putNumber(row + length, appoint->time.min, 2);
+    row[length++] = ' ';
+    length += putNumber(row + length, patient->patientNumber, 5);
+    row[length++] = ' ';
+    length += putPadded(row + length, patient->name, 15);
+    row[length++] = ' ';
+    length += putPhone(row + length, &patient->phone);
+    report->used += length;
+}
+
+// Adds every patient in FMT_FORM | FMT_TABLE format, as displayAllPatients shows them
+void reportPatients(struct Report* report, const struct ClinicData* data, int fmt)
+{
+    struct Patient patient;
+    long long started = startStat();
+    int patients = 0;
+    int i;
+
+    if (fmt == FMT_TABLE)
+    {
+        reportPatientHeader(report);
+    }
+
+    if (fmt == FMT_TABLE || fmt == FMT_FORM)
+    {
+        for (i = 0; i < data->maxPatient; i++)
+        {
+            patientAt(data, i, &patient);
+            reportPatient(report, &patient, fmt);
+            patients++;
+        }
+    }
+
+    if (patients == 0)
+    {
+        reportText(report, "\n*** No records found ***\n");
+    }
+
+    reportText(report, "\n");
+
+    recordStat(STAT_RENDER, started);
+}
+
+// Adds a row for each of count appointments from first whose patient exists (returns # of rows added)
+int reportSchedule(struct Report* report, const struct ClinicData* data, int first, int count, int includeDateField)
+{
+    struct Appointment appoint;
+    struct Patient patient;
+    long long started = startStat();
+    int patientIndex;
+    int rows = 0;
+    int i;
+
+    // Each appointment's patient is resolved through the patient number index
+    for (i = first; i < first + count; i++)
+    {
+        patientIndex = findPatientIndexByPatientNum(data->appointmentPatients[i], data);
+
+        if (patientIndex >= 0)
+        {
+            appointmentAt(data, i, &appoint);
+            patientAt(data, patientIndex, &patient);
+            reportScheduleRow(report, &patient, &appoint, includeDateField);
+            rows++;
+        }
+    }
+
+    recordStat(STAT_RENDER, started);
+
+    return rows;
+}
+
+// Writes the patient table and the full appointment schedule to a file ("-" is stdout),
+// returns 1 on success
+int writeReport(const struct ClinicData* data, const char* reportFile)
+{
+    struct Report report;
+    int fd = strcmp(reportFile, "-") == 0 ? STDOUT_FILENO : open(reportFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int written = fd >= 0;
+
+    if (written)
+    {
+        openReport(&report, fd);
+
+        reportPatients(&report, data, FMT_TABLE);
+        reportScheduleHeader(&report, NULL, 1);
+        reportSchedule(&report, data, 0, data->maxAppointments, 1);
+        reportText(&report, "\n");
+
+        written = closeReport(&report);
+
+        if (fd != STDOUT_FILENO)
+        {
+            written = close(fd) == 0 && written;
+        }
+    }
+
+    return written;
+}
+
+// Writes a summary of an appointmentData.txt file (appointments per month and per timeslot) to a file
+// ("-" is stdout), streaming the file in batches (returns # of appointments summarized, -1 on error)
+long writeAppointmentSummary(const char* datafile, const char* reportFile)
+{
+    struct AppointmentSummary* summary = calloc(1, sizeof(*summary));
+    struct Report report;
+    char* row;
+    long summarized = summary != NULL ? streamAppointments(datafile, summarizeAppointments, summary) : -1;
+    int fd = -1;
+    int length;
+
+    if (summarized >= 0)
+    {
+        fd = strcmp(reportFile, "-") == 0 ? STDOUT_FILENO : open(reportFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    if (fd >= 0)
+    {
+        openReport(&report, fd);
+        reportText(&report, "Appointment summary for: ");
+        reportText(&report, datafile);
+        reportText(&report, "\n\n");
+
+        if (summary->total > 0)
+        {
+            reportMonths(&report, summary);
+            reportSlots(&report, summary);
+
+            row = reserveRow(&report);
+            length = putPadded(row, "\nTotal: ", 0);
+            length += putCount(row + length, summary->total, 0);
+            length += putPadded(row + length, " appointments from ", 0);
+            length += putKey(row + length, summary->firstKey);
+            length += putPadded(row + length, " to ", 0);
+            length += putKey(row + length, summary->lastKey);
+            row[length++] = '\n';
+            report.used += length;
+        }
+        else
+        {
+            reportText(&report, "*** No records found ***\n");
+        }
+
+        reportText(&report, "\n");
+
+        summarized = closeReport(&report) ? summarized : -1;
+
+        if (fd != STDOUT_FILENO && close(fd) != 0)
+        {
+            summarized = -1;
+        }
+    }
+    else
+    {
+        summarized = -1;
+    }
+
+    free(summary);
+
+    return summarized;
+}
@@ -0,0 +1,79 @@
+/*
+*****************************************************************************
+The following functions render the patient and appointment tables shown by
+   the menus. Rows are formatted into a large buffer and written to a file
+   descriptor in big blocks, so a full table costs a few writes instead of
+                      several stdio calls per row.
+*****************************************************************************
+*/
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "clinic.h"
+
+// Bytes collected before each write
+#define REPORT_BUFFER_SIZE (1 << 16)
+
+// Digits of the largest count a summary can hold (a long)
+#define REPORT_COUNT_DIGITS 19
+
+// Longest row a report formats at once: a summary month row, a year then 13 counts of any size,
+// each after a space (a schedule row with its date is under 128)
+#define REPORT_ROW_MAX (4 + 13 * (1 + REPORT_COUNT_DIGITS) + 1)
+
+// Years an appointment summary counts the appointments of
+#define SUMMARY_YEARS (APPOINTMENT_LAST_YEAR - APPOINTMENT_FIRST_YEAR + 1)
+
+// Report being written to a file descriptor (declare it, then openReport)
+struct Report
+{
+    int fd;
+    int used;
+    int failed;
+    char buffer[REPORT_BUFFER_SIZE];
+};
+
+
+//////////////////////////////////////
+// REPORT FUNCTIONS
+//////////////////////////////////////
+
+// Starts a report on the file descriptor (stdout is flushed first when it is the target)
+void openReport(struct Report* report, int fd);
+
+// Writes out what is left in the buffer (returns 1 if the whole report was written)
+int closeReport(struct Report* report);
+
+// Adds text to the report
+void reportText(struct Report* report, const char* text);
+
+// Adds the patient table header (table format)
+void reportPatientHeader(struct Report* report);
+
+// Adds a patient record in FMT_FORM | FMT_TABLE format
+void reportPatient(struct Report* report, const struct Patient* patient, int fmt);
+
+// Adds the appointment schedule header (date-specific or all records)
+void reportScheduleHeader(struct Report* report, const struct Date* date, int isAllRecords);
+
+// Adds an appointment row with its patient's details
+void reportScheduleRow(struct Report* report, const struct Patient* patient,
+                       const struct Appointment* appoint, int includeDateField);
+
+// Adds every patient in FMT_FORM | FMT_TABLE format, as displayAllPatients shows them
+void reportPatients(struct Report* report, const struct ClinicData* data, int fmt);
+
+// Adds a row for each of count appointments from first whose patient exists (returns # of rows added)
+int reportSchedule(struct Report* report, const struct ClinicData* data, int first, int count, int includeDateField);
+
+// Writes the patient table and the full appointment schedule to a file ("-" is stdout),
+// returns 1 on success
+int writeReport(const struct ClinicData* data, const char* reportFile);
+
+// Writes a summary of an appointmentData.txt file (appointments per month and per timeslot) to a file
+// ("-" is stdout). The file is streamed, so it can be larger than memory (returns # of appointments
+// summarized, -1 if the file can't be read or the summary written).
+long writeAppointmentSummary(const char* datafile, const char* reportFile);
+
+#endif // !REPORT_H
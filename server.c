@@ -0,0 +1,507 @@
+/*
+*****************************************************************************
+The following functions serve the clinic data over a Unix domain socket,
+    keeping it loaded between requests. Clients send the batch commands
+   (see command.h) one per line and get the same answers back, in order.
+    Read-only commands from different clients run at the same time, a
+          command changing the data runs while nothing else does.
+  A connection keeps its worker until the client disconnects, so with N
+ threads client N+1 waits in the queue until one of the first N is done.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "command.h"
+#include "journal.h"
+#include "server.h"
+
+
+// A worker's read lock, alone on its cache line so readers on different cores never touch the same line
+struct ReaderSlot
+{
+    pthread_mutex_t lock;
+    char padding[SERVER_CACHE_LINE - sizeof(pthread_mutex_t) % SERVER_CACHE_LINE];
+};
+
+// State shared by the accepting thread and the workers
+struct Server
+{
+    struct ClinicData* data;
+
+    // Readers take their worker's slot, writers take writerLock and then every slot
+    // (a big-reader lock: reads scale with the workers, writes wait for the reads in progress)
+    struct ReaderSlot* readers;
+    int readerCount;
+    pthread_mutex_t writerLock;
+
+    pthread_mutex_t queueLock;      // guards everything below
+    pthread_cond_t queueReady;
+    int queue[SERVER_QUEUE_SIZE];   // accepted connections, oldest first
+    int queueHead;
+    int queueCount;
+    int* active;                    // connection each worker is serving (-1 = idle)
+    int stopping;
+};
+
+// A worker thread and the server it belongs to
+struct ServerWorker
+{
+    struct Server* server;
+    int id;
+    pthread_t thread;
+};
+
+// Set by SIGINT/SIGTERM
+static volatile sig_atomic_t stopRequested = 0;
+
+
+// Asks the server to stop
+static void requestStop(int signalNumber)
+{
+    (void)signalNumber;
+
+    stopRequested = 1;
+}
+
+// Takes the data for reading (any number of workers at once)
+static void lockReader(struct Server* server, int id)
+{
+    pthread_mutex_lock(&server->readers[id].lock);
+}
+
+// Releases the data after reading
+static void unlockReader(struct Server* server, int id)
+{
+    pthread_mutex_unlock(&server->readers[id].lock);
+}
+
+// Takes the data for writing, waiting for the reads in progress to end
+static void lockWriter(struct Server* server)
+{
+    int i;
+
+    pthread_mutex_lock(&server->writerLock);
+
+    for (i = 0; i < server->readerCount; i++)
+    {
+        pthread_mutex_lock(&server->readers[i].lock);
+    }
+}
+
+// Releases the data after writing
+static void unlockWriter(struct Server* server)
+{
+    int i;
+
+    for (i = server->readerCount - 1; i >= 0; i--)
+    {
+        pthread_mutex_unlock(&server->readers[i].lock);
+    }
+
+    pthread_mutex_unlock(&server->writerLock);
+}
+
+// Sends all the bytes, unless the client has gone away (returns 1 if they were sent)
+static int sendAll(int fd, const char* bytes, size_t length)
+{
+    size_t sent = 0;
+    ssize_t result = 0;
+
+    while (sent < length && result >= 0)
+    {
+        result = send(fd, bytes + sent, length - sent, MSG_NOSIGNAL);
+
+        if (result >= 0)
+        {
+            sent += (size_t)result;
+        }
+        else if (errno == EINTR)
+        {
+            result = 0;
+        }
+    }
+
+    return sent == length;
+}
+
+// Runs the complete lines of the buffer, returns the number of bytes used (a partial last line is left)
+static size_t runLines(struct Server* server, int id, char* buffer, size_t length, int* skipping, FILE* out)
+{
+    size_t start = 0;
+    size_t end;
+    char* newline;
+
+    while (start < length && (newline = memchr(buffer + start, '\n', length - start)) != NULL)
+    {
+        end = (size_t)(newline - buffer);
+
+        if (end > start && buffer[end - 1] == '\r')
+        {
+            buffer[end - 1] = '\0';
+        }
+
+        buffer[end] = '\0';
+
+        // The rest of a line that was too long to buffer has already been answered
+        if (*skipping)
+        {
+            *skipping = 0;
+        }
+        else if (end - start > COMMAND_LINE_MAX)
+        {
+            fprintf(out, "ERR Command line too long\n");
+        }
+        else if (commandWrites(buffer + start))
+        {
+            lockWriter(server);
+            executeCommand(server->data, buffer + start, out);
+            unlockWriter(server);
+        }
+        else
+        {
+            lockReader(server, id);
+            executeCommand(server->data, buffer + start, out);
+            unlockReader(server, id);
+        }
+
+        start = end + 1;
+    }
+
+    return start;
+}
+
+// Answers the commands of one client until it disconnects
+static void serveConnection(struct Server* server, int id, int fd)
+{
+    char buffer[SERVER_READ_SIZE];
+    size_t used = 0;
+    size_t consumed;
+    ssize_t bytes = 1;
+    int skipping = 0;
+    int connected = 1;
+    char* answers = NULL;
+    size_t answerLength = 0;
+    FILE* out;
+
+    while (connected && bytes > 0)
+    {
+        bytes = read(fd, buffer + used, sizeof(buffer) - used);
+
+        if (bytes < 0 && errno == EINTR)
+        {
+            bytes = 1;
+        }
+        else if (bytes > 0)
+        {
+            used += (size_t)bytes;
+
+            // The answers are collected in memory and sent after the data is unlocked,
+            // so a slow client never holds up the others
+            out = open_memstream(&answers, &answerLength);
+            connected = out != NULL;
+
+            if (connected)
+            {
+                consumed = runLines(server, id, buffer, used, &skipping, out);
+
+                if (consumed == 0 && used == sizeof(buffer))
+                {
+                    // No newline in a full buffer, answer once and drop the rest of the line
+                    if (!skipping)
+                    {
+                        fprintf(out, "ERR Command line too long\n");
+                    }
+
+                    skipping = 1;
+                    consumed = used;
+                }
+
+                fclose(out);
+                connected = sendAll(fd, answers, answerLength);
+                free(answers);
+                answers = NULL;
+
+                memmove(buffer, buffer + consumed, used - consumed);
+                used -= consumed;
+            }
+        }
+    }
+}
+
+// Worker thread: serves queued connections until the server stops
+static void* runServerWorker(void* argument)
+{
+    struct ServerWorker* worker = argument;
+    struct Server* server = worker->server;
+    int fd = -1;
+    int working = 1;
+
+    while (working)
+    {
+        pthread_mutex_lock(&server->queueLock);
+
+        while (server->queueCount == 0 && !server->stopping)
+        {
+            pthread_cond_wait(&server->queueReady, &server->queueLock);
+        }
+
+        working = server->queueCount > 0;
+
+        if (working)
+        {
+            fd = server->queue[server->queueHead];
+            server->queueHead = (server->queueHead + 1) % SERVER_QUEUE_SIZE;
+            server->queueCount--;
+            server->active[worker->id] = fd;
+        }
+
+        pthread_mutex_unlock(&server->queueLock);
+
+        if (working)
+        {
+            serveConnection(server, worker->id, fd);
+
+            pthread_mutex_lock(&server->queueLock);
+            server->active[worker->id] = -1;
+            pthread_mutex_unlock(&server->queueLock);
+
+            close(fd);
+        }
+    }
+
+    return NULL;
+}
+
+// Creates the listening socket, replacing a stale socket file left by a server that is gone (returns -1 on error)
+static int openListener(const char* socketPath)
+{
+    struct sockaddr_un address;
+    int fd = -1;
+    int probe;
+    int inUse = 0;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (strlen(socketPath) < sizeof(address.sun_path))
+    {
+        strcpy(address.sun_path, socketPath);
+
+        probe = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (probe >= 0)
+        {
+            inUse = connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+            close(probe);
+        }
+
+        if (inUse)
+        {
+            printf("ERROR: Another server is already listening on %s!\n", socketPath);
+        }
+        else
+        {
+            unlink(socketPath);
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        }
+    }
+    else
+    {
+        printf("ERROR: Socket path is too long!\n");
+    }
+
+    if (fd >= 0 && (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, SERVER_QUEUE_SIZE) != 0))
+    {
+        printf("ERROR: Unable to listen on %s!\n", socketPath);
+        close(fd);
+        fd = -1;
+    }
+
+    return fd;
+}
+
+// Hands an accepted connection to the workers (turned away if too many are waiting)
+static void queueConnection(struct Server* server, int fd)
+{
+    static const char busy[] = "ERR Server busy\n";
+    int queued;
+
+    pthread_mutex_lock(&server->queueLock);
+
+    queued = server->queueCount < SERVER_QUEUE_SIZE;
+
+    if (queued)
+    {
+        server->queue[(server->queueHead + server->queueCount) % SERVER_QUEUE_SIZE] = fd;
+        server->queueCount++;
+        pthread_cond_signal(&server->queueReady);
+    }
+
+    pthread_mutex_unlock(&server->queueLock);
+
+    if (!queued)
+    {
+        sendAll(fd, busy, sizeof(busy) - 1);
+        close(fd);
+    }
+}
+
+
+//////////////////////////////////////
+// SERVER FUNCTIONS
+//////////////////////////////////////
+
+// Serves commands on the socket path with a pool of worker threads until SIGINT/SIGTERM
+int runServer(struct ClinicData* data, const char* socketPath, int threads)
+{
+    struct Server server;
+    struct ServerWorker* workers = NULL;
+    struct sigaction action;
+    struct pollfd listener;
+    int started = 0;
+    int listenFd;
+    int fd;
+    int i;
+
+    memset(&server, 0, sizeof(server));
+    server.data = data;
+
+    listenFd = openListener(socketPath);
+
+    if (listenFd >= 0)
+    {
+        workers = malloc(sizeof(*workers) * threads);
+        server.active = malloc(sizeof(*server.active) * threads);
+
+        if (posix_memalign((void**)&server.readers, SERVER_CACHE_LINE, sizeof(*server.readers) * threads) != 0)
+        {
+            server.readers = NULL;
+        }
+    }
+
+    if (workers != NULL && server.active != NULL && server.readers != NULL)
+    {
+        server.readerCount = threads;
+
+        for (i = 0; i < threads; i++)
+        {
+            pthread_mutex_init(&server.readers[i].lock, NULL);
+        }
+
+        pthread_mutex_init(&server.writerLock, NULL);
+        pthread_mutex_init(&server.queueLock, NULL);
+        pthread_cond_init(&server.queueReady, NULL);
+
+        // No SA_RESTART, so a signal wakes the poll below
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = requestStop;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+
+        for (i = 0; i < threads; i++)
+        {
+            server.active[i] = -1;
+            workers[i].server = &server;
+            workers[i].id = i;
+        }
+
+        // Stops at the first thread that can't be created, so workers[0..started) are the live ones
+        for (i = 0; i < threads && started == i; i++)
+        {
+            if (pthread_create(&workers[i].thread, NULL, runServerWorker, &workers[i]) == 0)
+            {
+                started++;
+            }
+        }
+
+        printf("Listening on %s with %d threads...\n", socketPath, started);
+        fflush(stdout);
+
+        listener.fd = listenFd;
+        listener.events = POLLIN;
+
+        while (!stopRequested && started > 0)
+        {
+            if (poll(&listener, 1, SERVER_IDLE_MS) > 0)
+            {
+                fd = accept(listenFd, NULL, NULL);
+
+                if (fd >= 0)
+                {
+                    queueConnection(&server, fd);
+                }
+            }
+            else if (data->journal != NULL)
+            {
+                // Quiet moment: make sure the last records written are on disk
+                lockWriter(&server);
+                syncJournal(data->journal);
+                unlockWriter(&server);
+            }
+        }
+
+        // Stop taking connections, wake idle workers and disconnect the busy ones
+        close(listenFd);
+        unlink(socketPath);
+
+        pthread_mutex_lock(&server.queueLock);
+        server.stopping = 1;
+
+        for (i = 0; i < threads; i++)
+        {
+            if (server.active[i] != -1)
+            {
+                shutdown(server.active[i], SHUT_RDWR);
+            }
+        }
+
+        for (i = 0; i < server.queueCount; i++)
+        {
+            shutdown(server.queue[(server.queueHead + i) % SERVER_QUEUE_SIZE], SHUT_RDWR);
+        }
+
+        pthread_cond_broadcast(&server.queueReady);
+        pthread_mutex_unlock(&server.queueLock);
+
+        for (i = 0; i < started; i++)
+        {
+            pthread_join(workers[i].thread, NULL);
+        }
+
+        pthread_cond_destroy(&server.queueReady);
+        pthread_mutex_destroy(&server.queueLock);
+        pthread_mutex_destroy(&server.writerLock);
+
+        for (i = 0; i < threads; i++)
+        {
+            pthread_mutex_destroy(&server.readers[i].lock);
+        }
+
+        printf("Server stopped.\n");
+    }
+    else if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(socketPath);
+    }
+
+    free(workers);
+    free(server.active);
+    free(server.readers);
+
+    return started > 0;
+}
@@ -0,0 +1,43 @@
+/*
+*****************************************************************************
+The following functions serve the clinic data over a Unix domain socket,
+    keeping it loaded between requests. Clients send the batch commands
+   (see command.h) one per line and get the same answers back, in order.
+    Read-only commands from different clients run at the same time, a
+          command changing the data runs while nothing else does.
+  A connection keeps its worker until the client disconnects, so with N
+ threads client N+1 waits in the queue until one of the first N is done.
+*****************************************************************************
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "clinic.h"
+
+// Worker threads used when no thread count is given (one client connection each, for as long as it stays
+// connected: this is also how many clients can be served at once)
+#define SERVER_DEFAULT_THREADS 8
+
+// Accepted connections waiting for a free worker before new ones are turned away
+#define SERVER_QUEUE_SIZE 64
+
+// Bytes read from a client at a time
+#define SERVER_READ_SIZE 4096
+
+// Cache line size, each worker's read lock gets a line of its own
+#define SERVER_CACHE_LINE 64
+
+// Milliseconds between checks for unsynced journal records while idle
+#define SERVER_IDLE_MS 1000
+
+
+//////////////////////////////////////
+// SERVER FUNCTIONS
+//////////////////////////////////////
+
+// Serves commands on the socket path with a pool of worker threads until SIGINT/SIGTERM
+// (returns 1 after a clean shutdown, 0 if the socket can't be set up)
+int runServer(struct ClinicData* data, const char* socketPath, int threads);
+
+#endif // !SERVER_H
@@ -0,0 +1,712 @@
+/*
+*****************************************************************************
+The following functions save the patient and appointment tables, with their
+ indexes, to a binary snapshot that is mapped and used in place at startup
+   instead of importing the data files. A snapshot is a header followed by
+   fixed-width sections (the table columns, the name arena and the index
+    tables, see enum SnapshotSection), each one checksummed. It mirrors the
+ data files it was written from and is only loaded while they are unchanged.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "index.h"
+#include "snapshot.h"
+
+// Bytes collected before each write
+#define SNAPSHOT_BUFFER_SIZE (1 << 20)
+
+// Checksum lanes, each one hashes every 4th 8-byte word so the multiplies overlap
+#define CHECKSUM_LANES 4
+
+// Bytes the lanes take in at a time
+#define CHECKSUM_BLOCK (CHECKSUM_LANES * 8)
+
+#define CHECKSUM_PRIME 0x9E3779B97F4A7C15ull
+
+
+// Running checksum of a section, fed in pieces of any size
+struct Checksum
+{
+    unsigned long long lanes[CHECKSUM_LANES];
+    unsigned long long total;
+    unsigned char partial[CHECKSUM_BLOCK];
+    int partialSize;
+};
+
+// Snapshot file being written, through a large buffer
+struct SnapshotFile
+{
+    int fd;
+    int failed;
+    char* buffer;
+    size_t used;
+    unsigned long long offset;      // bytes written so far (including the buffer)
+    struct Checksum checksum;       // of the section being written
+};
+
+
+// Starts an empty checksum
+static void startChecksum(struct Checksum* checksum)
+{
+    int i;
+
+    for (i = 0; i < CHECKSUM_LANES; i++)
+    {
+        checksum->lanes[i] = CHECKSUM_PRIME * (i + 1);
+    }
+
+    checksum->total = 0;
+    checksum->partialSize = 0;
+}
+
+// Mixes whole blocks into the lanes
+static void checksumBlocks(struct Checksum* checksum, const unsigned char* bytes, size_t blocks)
+{
+    unsigned long long words[CHECKSUM_LANES];
+    unsigned long long lanes[CHECKSUM_LANES];
+    size_t i;
+    int lane;
+
+    // Kept in locals so the compiler can hold the lanes in registers
+    memcpy(lanes, checksum->lanes, sizeof(lanes));
+
+    for (i = 0; i < blocks; i++)
+    {
+        memcpy(words, bytes + i * CHECKSUM_BLOCK, CHECKSUM_BLOCK);
+
+        for (lane = 0; lane < CHECKSUM_LANES; lane++)
+        {
+            lanes[lane] = (lanes[lane] ^ words[lane]) * CHECKSUM_PRIME;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+
+    memcpy(checksum->lanes, lanes, sizeof(lanes));
+}
+
+// Adds bytes to the checksum
+static void addChecksum(struct Checksum* checksum, const void* bytes, size_t size)
+{
+    const unsigned char* next = bytes;
+    size_t part;
+
+    checksum->total += size;
+
+    // Finish the block left over from the last piece first
+    if (checksum->partialSize > 0)
+    {
+        part = CHECKSUM_BLOCK - checksum->partialSize < size ? CHECKSUM_BLOCK - checksum->partialSize : size;
+        memcpy(checksum->partial + checksum->partialSize, next, part);
+        checksum->partialSize += (int)part;
+        next += part;
+        size -= part;
+
+        if (checksum->partialSize == CHECKSUM_BLOCK)
+        {
+            checksumBlocks(checksum, checksum->partial, 1);
+            checksum->partialSize = 0;
+        }
+    }
+
+    checksumBlocks(checksum, next, size / CHECKSUM_BLOCK);
+
+    if (size % CHECKSUM_BLOCK > 0)
+    {
+        memcpy(checksum->partial, next + size - size % CHECKSUM_BLOCK, size % CHECKSUM_BLOCK);
+        checksum->partialSize = (int)(size % CHECKSUM_BLOCK);
+    }
+}
+
+// Finishes the checksum, returns its value
+static unsigned long long endChecksum(struct Checksum* checksum)
+{
+    unsigned long long value = checksum->total * CHECKSUM_PRIME;
+    int i;
+
+    // The last partial block is zero padded (the total tells the padding apart from data)
+    if (checksum->partialSize > 0)
+    {
+        memset(checksum->partial + checksum->partialSize, 0, CHECKSUM_BLOCK - checksum->partialSize);
+        checksumBlocks(checksum, checksum->partial, 1);
+        checksum->partialSize = 0;
+    }
+
+    for (i = 0; i < CHECKSUM_LANES; i++)
+    {
+        value = (value ^ checksum->lanes[i]) * CHECKSUM_PRIME;
+        value ^= value >> 31;
+    }
+
+    return value;
+}
+
+// Gets the checksum of a block of bytes
+static unsigned long long checksumOf(const void* bytes, size_t size)
+{
+    struct Checksum checksum;
+
+    startChecksum(&checksum);
+    addChecksum(&checksum, bytes, size);
+
+    return endChecksum(&checksum);
+}
+
+// Gets the checksum of a header (with its own checksum field left out)
+static unsigned long long headerChecksum(const struct SnapshotHeader* header)
+{
+    struct SnapshotHeader copy;
+
+    // Copied byte for byte so the padding between fields is checksummed as it is in the file
+    memcpy(&copy, header, sizeof(copy));
+    copy.checksum = 0;
+
+    return checksumOf(&copy, sizeof(copy));
+}
+
+// Reads the size, modification time and inode of a data file (all -1 if it doesn't exist)
+static void readStamp(const char* datafile, struct SnapshotStamp* stamp)
+{
+    struct stat info;
+
+    stamp->size = -1;
+    stamp->modified = -1;
+    stamp->inode = -1;
+
+    if (stat(datafile, &info) == 0)
+    {
+        stamp->size = (long long)info.st_size;
+        stamp->modified = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+        stamp->inode = (long long)info.st_ino;
+    }
+}
+
+// Checks if a data file is still the one the snapshot was written from (returns 1 if it is)
+static int isSameFile(const char* datafile, const struct SnapshotStamp* stamp)
+{
+    struct SnapshotStamp current;
+
+    readStamp(datafile, &current);
+
+    return current.size == stamp->size && current.modified == stamp->modified && current.inode == stamp->inode;
+}
+
+// Lays the sections out after the header from the counts in it, sets their offsets and sizes
+// and the file size (index sections are sized 0 when their table size is 0)
+static void layoutSections(struct SnapshotHeader* header)
+{
+    unsigned long long sizes[SNAPSHOT_SECTIONS];
+    unsigned long long offset = sizeof(*header);
+    int i;
+
+    sizes[SECTION_PATIENT_NUMBERS] = sizeof(int) * (unsigned long long)header->maxPatient;
+    sizes[SECTION_PATIENT_PHONES] = sizeof(long long) * (unsigned long long)header->maxPatient;
+    sizes[SECTION_PATIENT_CONTACTS] = sizeof(unsigned char) * (unsigned long long)header->maxPatient;
+    sizes[SECTION_PATIENT_NAMES] = sizeof(int) * (unsigned long long)header->maxPatient;
+    sizes[SECTION_NAME_ARENA] = (unsigned long long)header->nameArenaUsed;
+    sizes[SECTION_APPOINTMENT_PATIENTS] = sizeof(int) * (unsigned long long)header->maxAppointments;
+    sizes[SECTION_APPOINTMENT_TIMES] = sizeof(unsigned int) * (unsigned long long)header->maxAppointments;
+    sizes[SECTION_PATIENT_TABLE] = sizeof(int) * (unsigned long long)header->patientTableSize;
+    sizes[SECTION_PHONE_TABLE] = sizeof(struct PhoneSlot) * (unsigned long long)header->phoneTableSize;
+    sizes[SECTION_PHONE_NEXT] = header->phoneTableSize > 0 ? sizeof(int) * (unsigned long long)header->maxPatient : 0;
+    sizes[SECTION_NAME_STARTS] = header->namePostings >= 0 ? sizeof(int) * (NAME_TRIGRAMS + 1ull) : 0;
+    sizes[SECTION_NAME_SLOTS] = header->namePostings >= 0 ? sizeof(int) * (unsigned long long)header->namePostings : 0;
+    sizes[SECTION_DAY_SLOTS] = sizeof(struct DaySlots) * (unsigned long long)header->daySlotsSize;
+
+    for (i = 0; i < SNAPSHOT_SECTIONS; i++)
+    {
+        offset = (offset + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+        header->sections[i].offset = offset;
+        header->sections[i].size = sizes[i];
+        offset += sizes[i];
+    }
+
+    header->fileSize = offset;
+}
+
+// Writes out the snapshot buffer (marks the file as failed if it can't be written)
+static void flushSnapshot(struct SnapshotFile* out)
+{
+    size_t written = 0;
+    ssize_t bytes;
+
+    while (!out->failed && written < out->used)
+    {
+        bytes = write(out->fd, out->buffer + written, out->used - written);
+
+        if (bytes > 0)
+        {
+            written += (size_t)bytes;
+        }
+        else
+        {
+            out->failed = 1;
+        }
+    }
+
+    out->used = 0;
+}
+
+// Adds bytes to the file and to the checksum of the section being written
+static void putSnapshot(struct SnapshotFile* out, const void* bytes, size_t size)
+{
+    const char* next = bytes;
+    size_t part;
+
+    addChecksum(&out->checksum, bytes, size);
+    out->offset += size;
+
+    while (size > 0)
+    {
+        if (out->used == SNAPSHOT_BUFFER_SIZE)
+        {
+            flushSnapshot(out);
+        }
+
+        part = SNAPSHOT_BUFFER_SIZE - out->used < size ? SNAPSHOT_BUFFER_SIZE - out->used : size;
+        memcpy(out->buffer + out->used, next, part);
+        out->used += part;
+        next += part;
+        size -= part;
+    }
+}
+
+// Writes zeros up to the offset (the padding between sections)
+static void padSnapshot(struct SnapshotFile* out, unsigned long long offset)
+{
+    static const char zeros[SNAPSHOT_ALIGN] = { 0 };
+
+    while (out->offset < offset)
+    {
+        putSnapshot(out, zeros, offset - out->offset < SNAPSHOT_ALIGN ? offset - out->offset : SNAPSHOT_ALIGN);
+    }
+}
+
+// Writes the name index as its posting list starts and the lists one after the other
+static void putNameIndex(struct SnapshotFile* out, const struct ClinicData* data, int section)
+{
+    int start = 0;
+    int i;
+
+    for (i = 0; i < NAME_TRIGRAMS; i++)
+    {
+        if (section == SECTION_NAME_STARTS)
+        {
+            putSnapshot(out, &start, sizeof(start));
+            start += data->nameIndex[i].count;
+        }
+        else
+        {
+            putSnapshot(out, data->nameIndex[i].slots, sizeof(int) * data->nameIndex[i].count);
+        }
+    }
+
+    if (section == SECTION_NAME_STARTS)
+    {
+        putSnapshot(out, &start, sizeof(start));
+    }
+}
+
+// Writes one section of the snapshot
+static void putSection(struct SnapshotFile* out, const struct ClinicData* data, int section, size_t size)
+{
+    switch (section)
+    {
+    case SECTION_PATIENT_NUMBERS:
+        putSnapshot(out, data->patientNumbers, size);
+        break;
+    case SECTION_PATIENT_PHONES:
+        putSnapshot(out, data->patientPhones, size);
+        break;
+    case SECTION_PATIENT_CONTACTS:
+        putSnapshot(out, data->patientContacts, size);
+        break;
+    case SECTION_PATIENT_NAMES:
+        putSnapshot(out, data->patientNames, size);
+        break;
+    case SECTION_NAME_ARENA:
+        putSnapshot(out, data->nameArena, size);
+        break;
+    case SECTION_APPOINTMENT_PATIENTS:
+        putSnapshot(out, data->appointmentPatients, size);
+        break;
+    case SECTION_APPOINTMENT_TIMES:
+        putSnapshot(out, data->appointmentTimes, size);
+        break;
+    case SECTION_PATIENT_TABLE:
+        putSnapshot(out, data->patientTable, size);
+        break;
+    case SECTION_PHONE_TABLE:
+        putSnapshot(out, data->phoneTable, size);
+        break;
+    case SECTION_PHONE_NEXT:
+        putSnapshot(out, data->phoneNext, size);
+        break;
+    case SECTION_NAME_STARTS:
+    case SECTION_NAME_SLOTS:
+        if (size > 0)
+        {
+            putNameIndex(out, data, section);
+        }
+        break;
+    default:
+        putSnapshot(out, data->daySlots, size);
+        break;
+    }
+}
+
+// Fills in the header of a snapshot of the data (counts, stamps and section layout)
+static void fillHeader(struct SnapshotHeader* header, const struct ClinicData* data,
+                       const char* patientFile, const char* appointmentFile)
+{
+    int i;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = SNAPSHOT_VERSION;
+    header->byteOrder = SNAPSHOT_BYTE_ORDER;
+    header->headerSize = sizeof(*header);
+
+    readStamp(patientFile, &header->patientFile);
+    readStamp(appointmentFile, &header->appointmentFile);
+
+    header->maxPatient = data->maxPatient;
+    header->maxAppointments = data->maxAppointments;
+    header->lastPatientNumber = data->lastPatientNumber;
+    header->nameArenaUsed = data->nameArenaUsed;
+    header->nameArenaFree = data->nameArenaFree;
+    header->patientTableSize = data->patientTable != NULL ? data->patientTableSize : 0;
+    header->patientTableUsed = data->patientTable != NULL ? data->patientTableUsed : 0;
+    header->phoneTableSize = data->phoneTable != NULL ? data->phoneTableSize : 0;
+    header->phoneTableUsed = data->phoneTable != NULL ? data->phoneTableUsed : 0;
+    header->daySlotsSize = data->daySlots != NULL ? data->daySlotsSize : 0;
+    header->daySlotsUsed = data->daySlots != NULL ? data->daySlotsUsed : 0;
+
+    // -1 = no name index
+    header->namePostings = -1;
+
+    if (data->nameIndex != NULL)
+    {
+        for (i = 0, header->namePostings = 0; i < NAME_TRIGRAMS; i++)
+        {
+            header->namePostings += data->nameIndex[i].count;
+        }
+    }
+
+    layoutSections(header);
+}
+
+// Checks the header against the file and the data files (returns 1 if the snapshot can be used)
+static int isUsableHeader(const struct SnapshotHeader* header, size_t fileSize,
+                          const char* patientFile, const char* appointmentFile)
+{
+    struct SnapshotHeader layout;
+    int usable = fileSize >= sizeof(*header) &&
+                 memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == SNAPSHOT_VERSION &&
+                 header->byteOrder == SNAPSHOT_BYTE_ORDER &&
+                 header->headerSize == sizeof(*header) &&
+                 header->fileSize == fileSize &&
+                 header->checksum == headerChecksum(header) &&
+                 header->maxPatient >= 0 && header->maxAppointments >= 0 &&
+                 header->nameArenaUsed >= 0 &&
+                 header->patientTableSize >= 0 && header->phoneTableSize >= 0 && header->daySlotsSize >= 0 &&
+                 (header->patientTableSize & (header->patientTableSize - 1)) == 0 &&
+                 (header->phoneTableSize & (header->phoneTableSize - 1)) == 0 &&
+                 (header->daySlotsSize & (header->daySlotsSize - 1)) == 0 &&
+                 isSameFile(patientFile, &header->patientFile) &&
+                 isSameFile(appointmentFile, &header->appointmentFile);
+    int i;
+
+    // The sections must be exactly where the counts put them
+    if (usable)
+    {
+        layout = *header;
+        layoutSections(&layout);
+
+        for (i = 0; i < SNAPSHOT_SECTIONS; i++)
+        {
+            usable = usable && layout.sections[i].offset == header->sections[i].offset &&
+                     layout.sections[i].size == header->sections[i].size;
+        }
+
+        usable = usable && layout.fileSize == header->fileSize;
+    }
+
+    return usable;
+}
+
+// Gets where a section is in the mapped snapshot (NULL if it is empty)
+static void* sectionAt(char* snapshot, const struct SnapshotHeader* header, int section)
+{
+    return header->sections[section].size > 0 ? snapshot + header->sections[section].offset : NULL;
+}
+
+// Points the name index posting lists at the snapshot (returns 1 on success, 0 if the starts are damaged)
+static int mapNameIndex(struct ClinicData* data, const struct SnapshotHeader* header)
+{
+    const int* starts = sectionAt(data->snapshot, header, SECTION_NAME_STARTS);
+    int* slots = sectionAt(data->snapshot, header, SECTION_NAME_SLOTS);
+    int valid = starts[0] == 0 && starts[NAME_TRIGRAMS] == header->namePostings;
+    int i;
+
+    data->nameIndex = calloc(NAME_TRIGRAMS, sizeof(*data->nameIndex));
+
+    for (i = 0; valid && data->nameIndex != NULL && i < NAME_TRIGRAMS; i++)
+    {
+        valid = starts[i] <= starts[i + 1];
+
+        // Full lists, the first posting added to one moves it to the heap
+        if (valid && starts[i] < starts[i + 1])
+        {
+            data->nameIndex[i].slots = slots + starts[i];
+            data->nameIndex[i].count = starts[i + 1] - starts[i];
+            data->nameIndex[i].capacity = data->nameIndex[i].count;
+        }
+    }
+
+    if (!valid)
+    {
+        freeNameIndex(data);
+    }
+
+    return valid;
+}
+
+// Points the ClinicData tables and indexes at the snapshot sections (returns 1 on success)
+static int mapSnapshot(struct ClinicData* data, const struct SnapshotHeader* header)
+{
+    int mapped = 1;
+    int i;
+
+    // Every section has to be intact before any of it is used
+    for (i = 0; mapped && i < SNAPSHOT_SECTIONS; i++)
+    {
+        mapped = checksumOf(data->snapshot + header->sections[i].offset, header->sections[i].size) ==
+                 header->sections[i].checksum;
+    }
+
+    if (mapped)
+    {
+        data->maxPatient = header->maxPatient;
+        data->patientCapacity = header->maxPatient;
+        data->patientNumbers = sectionAt(data->snapshot, header, SECTION_PATIENT_NUMBERS);
+        data->patientPhones = sectionAt(data->snapshot, header, SECTION_PATIENT_PHONES);
+        data->patientContacts = sectionAt(data->snapshot, header, SECTION_PATIENT_CONTACTS);
+        data->patientNames = sectionAt(data->snapshot, header, SECTION_PATIENT_NAMES);
+
+        data->nameArena = sectionAt(data->snapshot, header, SECTION_NAME_ARENA);
+        data->nameArenaUsed = header->nameArenaUsed;
+        data->nameArenaCapacity = header->nameArenaUsed;
+        data->nameArenaFree = header->nameArenaFree;
+
+        data->lastPatientNumber = header->lastPatientNumber;
+
+        data->maxAppointments = header->maxAppointments;
+        data->appointmentCapacity = header->maxAppointments;
+        data->appointmentPatients = sectionAt(data->snapshot, header, SECTION_APPOINTMENT_PATIENTS);
+        data->appointmentTimes = sectionAt(data->snapshot, header, SECTION_APPOINTMENT_TIMES);
+
+        data->patientTable = sectionAt(data->snapshot, header, SECTION_PATIENT_TABLE);
+        data->patientTableSize = header->patientTableSize;
+        data->patientTableUsed = header->patientTableUsed;
+
+        // The phone and name indexes are optional, they are only used along with the patient number index
+        if (data->patientTable != NULL && header->phoneTableSize > 0)
+        {
+            data->phoneTable = sectionAt(data->snapshot, header, SECTION_PHONE_TABLE);
+            data->phoneTableSize = header->phoneTableSize;
+            data->phoneTableUsed = header->phoneTableUsed;
+            data->phoneNext = sectionAt(data->snapshot, header, SECTION_PHONE_NEXT);
+        }
+
+        if (data->patientTable != NULL && header->namePostings >= 0)
+        {
+            mapped = mapNameIndex(data, header);
+        }
+
+        data->daySlots = sectionAt(data->snapshot, header, SECTION_DAY_SLOTS);
+        data->daySlotsSize = header->daySlotsSize;
+        data->daySlotsUsed = header->daySlotsUsed;
+
+        // Indexes missing from the snapshot (their build ran out of memory) are built now, so are the
+        // ones of an empty patient table (the phone links are sized by its capacity, 0 when mapped)
+        if (data->patientTable == NULL || (data->maxPatient == 0 && reservePatients(data, 1)))
+        {
+            buildPatientIndex(data);
+        }
+
+        if (data->daySlots == NULL)
+        {
+            buildSlotIndex(data);
+        }
+    }
+
+    return mapped;
+}
+
+
+//////////////////////////////////////
+// SNAPSHOT FUNCTIONS
+//////////////////////////////////////
+
+// Writes the tables and indexes to the snapshot file, stamped with the data files they were loaded from
+// (returns 1 on success). It is written to "<snapshotFile>.tmp" which then replaces the file.
+int writeSnapshot(const char* snapshotFile, const struct ClinicData* data,
+                  const char* patientFile, const char* appointmentFile)
+{
+    struct SnapshotFile out = { -1, 0, NULL, 0, 0 };
+    struct SnapshotHeader header;
+    char* tempfile = malloc(strlen(snapshotFile) + 5);
+    char* directory = NULL;
+    int written = 0;
+    int i;
+    int fd;
+
+    fillHeader(&header, data, patientFile, appointmentFile);
+    out.buffer = malloc(SNAPSHOT_BUFFER_SIZE);
+
+    if (tempfile != NULL && out.buffer != NULL)
+    {
+        strcpy(tempfile, snapshotFile);
+        strcat(tempfile, ".tmp");
+        out.fd = open(tempfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    if (out.fd >= 0)
+    {
+        // The header goes first as a placeholder, it is rewritten once the section checksums are known
+        startChecksum(&out.checksum);
+        putSnapshot(&out, &header, sizeof(header));
+
+        for (i = 0; i < SNAPSHOT_SECTIONS; i++)
+        {
+            padSnapshot(&out, header.sections[i].offset);
+            startChecksum(&out.checksum);
+            putSection(&out, data, i, header.sections[i].size);
+            header.sections[i].checksum = endChecksum(&out.checksum);
+        }
+
+        flushSnapshot(&out);
+
+        header.checksum = headerChecksum(&header);
+        out.failed = out.failed || out.offset != header.fileSize ||
+                     pwrite(out.fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header);
+        out.failed = out.failed || fsync(out.fd) != 0;
+        out.failed = close(out.fd) != 0 || out.failed;
+
+        // A loaded snapshot keeps its own mapping of the old file, so replacing it is safe
+        if (!out.failed && rename(tempfile, snapshotFile) == 0)
+        {
+            written = 1;
+            directory = malloc(strlen(snapshotFile) + 1);
+
+            if (directory != NULL)
+            {
+                strcpy(directory, snapshotFile);
+                fd = open(dirname(directory), O_RDONLY);
+
+                if (fd >= 0)
+                {
+                    fsync(fd);
+                    close(fd);
+                }
+            }
+        }
+        else
+        {
+            unlink(tempfile);
+        }
+    }
+
+    free(directory);
+    free(tempfile);
+    free(out.buffer);
+
+    return written;
+}
+
+// Maps the snapshot file into empty ClinicData, using its tables and indexes in place (returns 1 on success,
+// 0 if it is missing, damaged, of another version or no longer matches the data files)
+int loadSnapshot(const char* snapshotFile, struct ClinicData* data,
+                 const char* patientFile, const char* appointmentFile)
+{
+    const struct ClinicData empty = { 0 };
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    int loaded = 0;
+    int fd = open(snapshotFile, O_RDONLY);
+
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(struct SnapshotHeader))
+    {
+        // Private and writable: changed pages are copied for this process, the file is never written.
+        // (MAP_POPULATE would copy every page up front, the checksums only need to read them.)
+        mapping = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (mapping != MAP_FAILED)
+    {
+        *data = empty;
+        data->snapshot = mapping;
+        data->snapshotSize = (size_t)info.st_size;
+
+        loaded = isUsableHeader(mapping, data->snapshotSize, patientFile, appointmentFile) &&
+                 mapSnapshot(data, mapping);
+
+        if (!loaded)
+        {
+            freeClinicData(data);
+        }
+    }
+
+    return loaded;
+}
+
+// Checks if the snapshot file was written from the data files as they are now (returns 1 if it was)
+int isSnapshotCurrent(const char* snapshotFile, const char* patientFile, const char* appointmentFile)
+{
+    struct SnapshotHeader header;
+    int current = 0;
+    int fd = open(snapshotFile, O_RDONLY);
+
+    if (fd >= 0)
+    {
+        current = read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header) &&
+                  memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 &&
+                  header.version == SNAPSHOT_VERSION &&
+                  header.checksum == headerChecksum(&header) &&
+                  isSameFile(patientFile, &header.patientFile) &&
+                  isSameFile(appointmentFile, &header.appointmentFile);
+        close(fd);
+    }
+
+    return current;
+}
+
+// Unmaps the loaded snapshot (call once nothing points into it any more)
+void unloadSnapshot(struct ClinicData* data)
+{
+    if (data->snapshot != NULL)
+    {
+        munmap(data->snapshot, data->snapshotSize);
+    }
+
+    data->snapshot = NULL;
+    data->snapshotSize = 0;
+}
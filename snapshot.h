@@ -0,0 +1,117 @@
+/*
+*****************************************************************************
+The following functions save the patient and appointment tables, with their
+ indexes, to a binary snapshot that is mapped and used in place at startup
+   instead of importing the data files. A snapshot is a header followed by
+   fixed-width sections (the table columns, the name arena and the index
+    tables, see enum SnapshotSection), each one checksummed. It mirrors the
+ data files it was written from and is only loaded while they are unchanged.
+*****************************************************************************
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "clinic.h"
+
+// First bytes of every snapshot file
+#define SNAPSHOT_MAGIC "CLINSNAP"
+
+// Layout version, bumped whenever the header or a section changes
+#define SNAPSHOT_VERSION 2
+
+// Marks the byte order the snapshot was written in (it is only read on the same kind of machine)
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+// Sections start on cache line boundaries
+#define SNAPSHOT_ALIGN 64
+
+// Sections of a snapshot, in file order (an empty index section means the index wasn't built)
+enum SnapshotSection
+{
+    SECTION_PATIENT_NUMBERS,        // int[maxPatient]
+    SECTION_PATIENT_PHONES,         // long long[maxPatient]
+    SECTION_PATIENT_CONTACTS,       // unsigned char[maxPatient]
+    SECTION_PATIENT_NAMES,          // int[maxPatient], offsets in the name arena
+    SECTION_NAME_ARENA,             // char[nameArenaUsed]
+    SECTION_APPOINTMENT_PATIENTS,   // int[maxAppointments]
+    SECTION_APPOINTMENT_TIMES,      // unsigned int[maxAppointments], sorted
+    SECTION_PATIENT_TABLE,          // int[patientTableSize]
+    SECTION_PHONE_TABLE,            // struct PhoneSlot[phoneTableSize]
+    SECTION_PHONE_NEXT,             // int[maxPatient]
+    SECTION_NAME_STARTS,            // int[NAME_TRIGRAMS + 1], where each trigram's postings start
+    SECTION_NAME_SLOTS,             // int[], every posting list one after the other
+    SECTION_DAY_SLOTS,              // struct DaySlots[daySlotsSize]
+    SNAPSHOT_SECTIONS
+};
+
+// Where a section is in the file and the checksum of its bytes
+struct SnapshotExtent
+{
+    unsigned long long offset;
+    unsigned long long size;
+    unsigned long long checksum;
+};
+
+// Identifies a data file as it was when the snapshot was written (all -1 if it didn't exist)
+struct SnapshotStamp
+{
+    long long size;
+    long long modified;             // nanoseconds
+    long long inode;
+};
+
+// Start of a snapshot file
+struct SnapshotHeader
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int byteOrder;
+    unsigned int headerSize;        // sizeof(struct SnapshotHeader)
+    unsigned int reserved;
+    unsigned long long fileSize;
+    unsigned long long checksum;    // of the header, with this field set to 0
+
+    // Data files the tables were loaded from
+    struct SnapshotStamp patientFile;
+    struct SnapshotStamp appointmentFile;
+
+    // ClinicData counts the sections are sized by
+    int maxPatient;
+    int maxAppointments;
+    int lastPatientNumber;
+    int nameArenaUsed;
+    int nameArenaFree;
+    int patientTableSize;
+    int patientTableUsed;
+    int phoneTableSize;
+    int phoneTableUsed;
+    int daySlotsSize;
+    int daySlotsUsed;
+    int namePostings;
+
+    struct SnapshotExtent sections[SNAPSHOT_SECTIONS];
+};
+
+
+//////////////////////////////////////
+// SNAPSHOT FUNCTIONS
+//////////////////////////////////////
+
+// Writes the tables and indexes to the snapshot file, stamped with the data files they were loaded from
+// (returns 1 on success). It is written to "<snapshotFile>.tmp" which then replaces the file.
+int writeSnapshot(const char* snapshotFile, const struct ClinicData* data,
+                  const char* patientFile, const char* appointmentFile);
+
+// Maps the snapshot file into empty ClinicData, using its tables and indexes in place (returns 1 on success,
+// 0 if it is missing, damaged, of another version or no longer matches the data files)
+int loadSnapshot(const char* snapshotFile, struct ClinicData* data,
+                 const char* patientFile, const char* appointmentFile);
+
+// Checks if the snapshot file was written from the data files as they are now (returns 1 if it was)
+int isSnapshotCurrent(const char* snapshotFile, const char* patientFile, const char* appointmentFile);
+
+// Unmaps the loaded snapshot (call once nothing points into it any more)
+void unloadSnapshot(struct ClinicData* data);
+
+#endif // !SNAPSHOT_H
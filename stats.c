@@ -0,0 +1,286 @@
+/*
+*****************************************************************************
+The following functions time the hot paths (imports, lookups, searches, the
+  sort, conflict checks, booking and rendering) while statistics are turned
+  on. Each kind of operation gets a counter and a latency histogram with 16
+ buckets per power of two (values are kept to within about 6%), updated with
+       atomic adds so server threads can record at the same time.
+*****************************************************************************
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <time.h>
+
+#include "stats.h"
+
+// Counter and histogram of one kind of operation
+struct StatCounters
+{
+    unsigned long long count;
+    unsigned long long total;
+    unsigned long long min;         // 0 = nothing recorded yet
+    unsigned long long max;
+    unsigned long long buckets[STATS_BUCKETS];
+};
+
+// Names used by displayStats and the stats file, by enum StatKind
+static const char* const statNames[STAT_KINDS] = {
+    "import_patients", "import_appointments", "patient_lookup", "phone_search", "name_search",
+    "sort", "conflict_check", "booking", "render"
+};
+
+static struct StatCounters counters[STAT_KINDS];
+
+static int enabled = 0;
+
+
+// Gets the monotonic clock in nanoseconds (never 0, that means statistics were off)
+static long long nowNanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec + 1;
+}
+
+// Gets the histogram bucket of a value: exact below STATS_SUB_BUCKETS, then STATS_SUB_BUCKETS per power of two
+static int bucketOf(unsigned long long value)
+{
+    int exponent;
+    int bucket = (int)value;
+
+    if (value >= STATS_SUB_BUCKETS)
+    {
+        exponent = 63 - __builtin_clzll(value);
+        bucket = (exponent - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS +
+                 (int)((value >> (exponent - STATS_SUB_BITS)) & (STATS_SUB_BUCKETS - 1));
+    }
+
+    return bucket;
+}
+
+// Gets the largest value that falls in a histogram bucket
+static unsigned long long bucketLimit(int bucket)
+{
+    int shift = bucket / STATS_SUB_BUCKETS - 1;
+    unsigned long long limit = (unsigned long long)bucket;
+
+    if (bucket >= STATS_SUB_BUCKETS)
+    {
+        limit = ((unsigned long long)(STATS_SUB_BUCKETS + bucket % STATS_SUB_BUCKETS) << shift) + ((1ull << shift) - 1);
+    }
+
+    return limit;
+}
+
+// Gets the value below which the fraction of the recorded values fall (the limit of the bucket reaching it)
+static unsigned long long percentile(const struct StatCounters* stat, double fraction)
+{
+    unsigned long long wanted = (unsigned long long)(fraction * __atomic_load_n(&stat->count, __ATOMIC_RELAXED));
+    unsigned long long seen = 0;
+    int bucket = 0;
+
+    for (; bucket < STATS_BUCKETS - 1; bucket++)
+    {
+        seen += __atomic_load_n(&stat->buckets[bucket], __ATOMIC_RELAXED);
+
+        if (seen > wanted)
+        {
+            break;
+        }
+    }
+
+    return bucketLimit(bucket);
+}
+
+// Lowers the stored value to the new one if it is smaller (0 counts as unset)
+static void storeMin(unsigned long long* stored, unsigned long long value)
+{
+    unsigned long long current = __atomic_load_n(stored, __ATOMIC_RELAXED);
+
+    while ((current == 0 || value < current) &&
+           !__atomic_compare_exchange_n(stored, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        ; // current was reloaded, try again
+    }
+}
+
+// Raises the stored value to the new one if it is larger
+static void storeMax(unsigned long long* stored, unsigned long long value)
+{
+    unsigned long long current = __atomic_load_n(stored, __ATOMIC_RELAXED);
+
+    while (value > current &&
+           !__atomic_compare_exchange_n(stored, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        ; // current was reloaded, try again
+    }
+}
+
+
+//////////////////////////////////////
+// STATS FUNCTIONS
+//////////////////////////////////////
+
+// Turns statistics on or off (they start off, timing then costs a single check)
+void setStatsEnabled(int on)
+{
+    __atomic_store_n(&enabled, on != 0, __ATOMIC_RELAXED);
+}
+
+// Checks if statistics are on (returns 1 if they are)
+int statsEnabled(void)
+{
+    return __atomic_load_n(&enabled, __ATOMIC_RELAXED);
+}
+
+// Clears every counter and histogram
+void resetStats(void)
+{
+    struct StatCounters* stat;
+    int kind;
+    int bucket;
+
+    // Cleared one field at a time, server threads may be recording
+    for (kind = 0; kind < STAT_KINDS; kind++)
+    {
+        stat = &counters[kind];
+
+        __atomic_store_n(&stat->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&stat->total, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&stat->min, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&stat->max, 0, __ATOMIC_RELAXED);
+
+        for (bucket = 0; bucket < STATS_BUCKETS; bucket++)
+        {
+            __atomic_store_n(&stat->buckets[bucket], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Starts timing an operation (returns 0 while statistics are off), pass the result to recordStat
+long long startStat(void)
+{
+    return statsEnabled() ? nowNanoseconds() : 0;
+}
+
+// Counts an operation of the kind and adds its time since start to the histogram (nothing if start is 0)
+void recordStat(enum StatKind kind, long long start)
+{
+    struct StatCounters* stat = &counters[kind];
+    unsigned long long elapsed;
+
+    if (start != 0)
+    {
+        elapsed = (unsigned long long)(nowNanoseconds() - start);
+
+        __atomic_fetch_add(&stat->count, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stat->total, elapsed, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stat->buckets[bucketOf(elapsed)], 1, __ATOMIC_RELAXED);
+        storeMin(&stat->min, elapsed > 0 ? elapsed : 1);
+        storeMax(&stat->max, elapsed);
+    }
+}
+
+// Gets the count, total, extremes and percentiles recorded for a kind of operation
+void readStat(enum StatKind kind, struct StatSummary* summary)
+{
+    const struct StatCounters* stat = &counters[kind];
+
+    summary->name = statNames[kind];
+    summary->count = __atomic_load_n(&stat->count, __ATOMIC_RELAXED);
+    summary->total = __atomic_load_n(&stat->total, __ATOMIC_RELAXED);
+    summary->min = __atomic_load_n(&stat->min, __ATOMIC_RELAXED);
+    summary->max = __atomic_load_n(&stat->max, __ATOMIC_RELAXED);
+    summary->p50 = summary->count > 0 ? percentile(stat, 0.5) : 0;
+    summary->p90 = summary->count > 0 ? percentile(stat, 0.9) : 0;
+    summary->p99 = summary->count > 0 ? percentile(stat, 0.99) : 0;
+    summary->p999 = summary->count > 0 ? percentile(stat, 0.999) : 0;
+
+    // The bucket limits can overshoot the largest value seen
+    summary->p50 = summary->p50 < summary->max ? summary->p50 : summary->max;
+    summary->p90 = summary->p90 < summary->max ? summary->p90 : summary->max;
+    summary->p99 = summary->p99 < summary->max ? summary->p99 : summary->max;
+    summary->p999 = summary->p999 < summary->max ? summary->p999 : summary->max;
+}
+
+// Displays every kind of operation recorded, with its count, total and latency percentiles
+void displayStats(FILE* out)
+{
+    struct StatSummary summary;
+    int shown = 0;
+    int kind;
+
+    fprintf(out, "Operation              Count   Total ms    p50 us    p90 us    p99 us    Max us\n"
+                 "------------------- -------- ---------- --------- --------- --------- ---------\n");
+
+    for (kind = 0; kind < STAT_KINDS; kind++)
+    {
+        readStat(kind, &summary);
+
+        if (summary.count > 0)
+        {
+            fprintf(out, "%-19s %8llu %10.1f %9.1f %9.1f %9.1f %9.1f\n", summary.name, summary.count,
+                    summary.total / 1e6, summary.p50 / 1e3, summary.p90 / 1e3, summary.p99 / 1e3, summary.max / 1e3);
+            shown++;
+        }
+    }
+
+    if (shown == 0)
+    {
+        fprintf(out, "\n*** No records found ***\n");
+    }
+
+    fprintf(out, "\n");
+}
+
+// Writes the statistics as JSON, with the non-empty histogram buckets (returns 1 on success)
+int writeStatsFile(const char* statsFile)
+{
+    struct StatSummary summary;
+    unsigned long long count;
+    FILE* fp = fopen(statsFile, "w");
+    int written = fp != NULL;
+    int first;
+    int kind;
+    int bucket;
+
+    if (written)
+    {
+        fprintf(fp, "{\n  \"enabled\": %s,\n  \"operations\": [\n", statsEnabled() ? "true" : "false");
+
+        for (kind = 0; kind < STAT_KINDS; kind++)
+        {
+            readStat(kind, &summary);
+            fprintf(fp, "    { \"name\": \"%s\", \"count\": %llu, \"total_ns\": %llu, \"min_ns\": %llu, \"max_ns\": %llu, "
+                        "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu,\n"
+                        "      \"buckets\": [",
+                    summary.name, summary.count, summary.total, summary.min, summary.max,
+                    summary.p50, summary.p90, summary.p99, summary.p999);
+
+            // [largest value in the bucket, values in it]
+            for (bucket = 0, first = 1; bucket < STATS_BUCKETS; bucket++)
+            {
+                count = __atomic_load_n(&counters[kind].buckets[bucket], __ATOMIC_RELAXED);
+
+                if (count > 0)
+                {
+                    fprintf(fp, "%s[%llu, %llu]", first ? "" : ", ", bucketLimit(bucket), count);
+                    first = 0;
+                }
+            }
+
+            fprintf(fp, "] }%s\n", kind < STAT_KINDS - 1 ? "," : "");
+        }
+
+        fprintf(fp, "  ]\n}\n");
+
+        written = !ferror(fp);
+        written = fclose(fp) == 0 && written;
+    }
+
+    return written;
+}
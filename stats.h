@@ -0,0 +1,83 @@
+/*
+*****************************************************************************
+The following functions time the hot paths (imports, lookups, searches, the
+  sort, conflict checks, booking and rendering) while statistics are turned
+  on. Each kind of operation gets a counter and a latency histogram with 16
+ buckets per power of two (values are kept to within about 6%), updated with
+       atomic adds so server threads can record at the same time.
+*****************************************************************************
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+// Bits of each value kept below its highest bit (histogram precision)
+#define STATS_SUB_BITS 4
+
+// Histogram buckets per power of two
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BITS)
+
+// Histogram buckets covering every 64-bit nanosecond value
+#define STATS_BUCKETS ((64 - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS)
+
+// Kinds of operation timed
+enum StatKind
+{
+    STAT_IMPORT_PATIENTS,
+    STAT_IMPORT_APPOINTMENTS,
+    STAT_PATIENT_LOOKUP,            // findPatientIndexByPatientNum
+    STAT_PHONE_SEARCH,              // lookupPhone
+    STAT_NAME_SEARCH,               // searchPatientName
+    STAT_SORT,                      // sortAppointments
+    STAT_CONFLICT_CHECK,            // isSlotTaken
+    STAT_BOOKING,                   // insertAppointment
+    STAT_RENDER,                    // reportPatients / reportSchedule
+    STAT_KINDS
+};
+
+// What has been recorded for a kind of operation (times in nanoseconds)
+struct StatSummary
+{
+    const char* name;
+    unsigned long long count;
+    unsigned long long total;
+    unsigned long long min;
+    unsigned long long max;
+    unsigned long long p50;
+    unsigned long long p90;
+    unsigned long long p99;
+    unsigned long long p999;
+};
+
+
+//////////////////////////////////////
+// STATS FUNCTIONS
+//////////////////////////////////////
+
+// Turns statistics on or off (they start off, timing then costs a single check)
+void setStatsEnabled(int enabled);
+
+// Checks if statistics are on (returns 1 if they are)
+int statsEnabled(void);
+
+// Clears every counter and histogram
+void resetStats(void);
+
+// Starts timing an operation (returns 0 while statistics are off), pass the result to recordStat
+long long startStat(void);
+
+// Counts an operation of the kind and adds its time since start to the histogram (nothing if start is 0)
+void recordStat(enum StatKind kind, long long start);
+
+// Gets the count, total, extremes and percentiles recorded for a kind of operation
+void readStat(enum StatKind kind, struct StatSummary* summary);
+
+// Displays every kind of operation recorded, with its count, total and latency percentiles
+void displayStats(FILE* out);
+
+// Writes the statistics as JSON, with the non-empty histogram buckets (returns 1 on success)
+int writeStatsFile(const char* statsFile);
+
+#endif // !STATS_H